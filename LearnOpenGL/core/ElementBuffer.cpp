@@ -2,17 +2,36 @@
 
 ElementBuffer::ElementBuffer(const unsigned int* indices, const int size) : m_ID()
 {
+	// The element buffer binding belongs to the bound vertex array, which must be left untouched.
+	GLStateCache::bindVertexArray(0);
+
 	glGenBuffers(1, &m_ID);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	ResourceTracker::track(ResourceTracker::Category::BUFFER, m_ID, size);
 }
 
 ElementBuffer::~ElementBuffer()
 {
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_ID);
+
 	glDeleteBuffers(1, &m_ID);
 }
 
+ElementBuffer::ElementBuffer(ElementBuffer&& other) noexcept : m_ID(other.m_ID)
+{
+	other.m_ID = 0;
+}
+
+ElementBuffer& ElementBuffer::operator=(ElementBuffer&& other) noexcept
+{
+	std::swap(m_ID, other.m_ID);
+
+	return *this;
+}
+
 void ElementBuffer::bind()
 {
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
@@ -1,13 +1,24 @@
 #pragma once
 
+#include <utility>
+
 #include <glad/glad.h>
 
+#include "ResourceTracker.h"
+#include "GLStateCache.h"
+
 class ElementBuffer
 {
 public:
 	ElementBuffer(const unsigned int* indices, const int size);
 	~ElementBuffer();
 
+	ElementBuffer(ElementBuffer&& other) noexcept;
+	ElementBuffer& operator=(ElementBuffer&& other) noexcept;
+
+	ElementBuffer(const ElementBuffer&) = delete;
+	ElementBuffer& operator=(const ElementBuffer&) = delete;
+
 	void bind();
 	void unbind();
 
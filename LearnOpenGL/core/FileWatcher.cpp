@@ -0,0 +1,246 @@
+#include "FileWatcher.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+FileWatcher::FileWatcher(const char* directory)
+	: m_Directory(normalizeFilepath(directory)), m_Thread(), m_Running(true), m_Mutex(), m_ChangedFiles()
+{
+	m_Thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+	// The watching loops wake up periodically to check this flag.
+	m_Running = false;
+
+	if (m_Thread.joinable())
+	{
+		m_Thread.join();
+	}
+}
+
+std::vector<std::string> FileWatcher::pollChanges()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	std::vector<std::string> changedFiles(m_ChangedFiles.begin(), m_ChangedFiles.end());
+
+	m_ChangedFiles.clear();
+
+	return changedFiles;
+}
+
+void FileWatcher::notify(const std::string& filepath)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// Editors usually trigger several events per save, the set merges them.
+	m_ChangedFiles.insert(normalizeFilepath(filepath));
+}
+
+#if defined(_WIN32)
+
+void FileWatcher::run()
+{
+	HANDLE directory = CreateFileW(std::filesystem::path(m_Directory).wstring().c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+
+	if (directory == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "[ERROR] FILE WATCHER: Failed to watch directory \"" << m_Directory << "\"." << std::endl;
+
+		return;
+	}
+
+	OVERLAPPED overlapped = {};
+	DWORD buffer[4096]; // DWORD-aligned, as required by ReadDirectoryChangesW.
+
+	overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+	while (m_Running)
+	{
+		DWORD numberOfBytes = 0;
+
+		ResetEvent(overlapped.hEvent);
+
+		if (!ReadDirectoryChangesW(directory, buffer, sizeof(buffer), TRUE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, NULL, &overlapped, NULL))
+		{
+			std::cout << "[ERROR] FILE WATCHER: Failed to read changes of directory \"" << m_Directory << "\"." << std::endl;
+
+			break;
+		}
+
+		while (m_Running && WaitForSingleObject(overlapped.hEvent, 100) == WAIT_TIMEOUT)
+		{
+		}
+
+		if (!m_Running)
+		{
+			CancelIo(directory);
+			GetOverlappedResult(directory, &overlapped, &numberOfBytes, TRUE);
+
+			break;
+		}
+
+		// Zero bytes means that the buffer overflowed and the changes were lost.
+		if (!GetOverlappedResult(directory, &overlapped, &numberOfBytes, FALSE) || numberOfBytes == 0)
+		{
+			continue;
+		}
+
+		const char* entry = (const char*)buffer;
+
+		while (true)
+		{
+			const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)entry;
+
+			if (info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+			{
+				std::wstring filename(info->FileName, info->FileNameLength / sizeof(WCHAR));
+
+				notify((std::filesystem::path(m_Directory) / filename).generic_string());
+			}
+
+			if (info->NextEntryOffset == 0)
+			{
+				break;
+			}
+
+			entry += info->NextEntryOffset;
+		}
+	}
+
+	CloseHandle(overlapped.hEvent);
+	CloseHandle(directory);
+}
+
+#elif defined(__linux__)
+
+void FileWatcher::run()
+{
+	int fileDescriptor = inotify_init1(IN_NONBLOCK);
+	std::unordered_map<int, std::string> watchedDirectories;
+
+	if (fileDescriptor < 0)
+	{
+		std::cout << "[ERROR] FILE WATCHER: Failed to initialize inotify." << std::endl;
+
+		return;
+	}
+
+	// Watches aren't recursive, so every subdirectory gets its own.
+	auto addWatch = [&](const std::string& directory)
+	{
+		int watchDescriptor = inotify_add_watch(fileDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+
+		if (watchDescriptor >= 0)
+		{
+			watchedDirectories[watchDescriptor] = directory;
+		}
+		else
+		{
+			std::cout << "[ERROR] FILE WATCHER: Failed to watch directory \"" << directory << "\"." << std::endl;
+		}
+	};
+
+	std::error_code error;
+
+	addWatch(m_Directory);
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(m_Directory, error))
+	{
+		if (entry.is_directory())
+		{
+			addWatch(entry.path().generic_string());
+		}
+	}
+
+	alignas(inotify_event) char buffer[4096];
+
+	while (m_Running)
+	{
+		pollfd request = { fileDescriptor, POLLIN, 0 };
+
+		if (poll(&request, 1, 100) <= 0)
+		{
+			continue;
+		}
+
+		ssize_t length = read(fileDescriptor, buffer, sizeof(buffer));
+
+		for (char* entry = buffer; entry < buffer + length; )
+		{
+			const inotify_event* event = (const inotify_event*)entry;
+
+			entry += sizeof(inotify_event) + event->len;
+
+			if (event->len == 0 || watchedDirectories.count(event->wd) == 0)
+			{
+				continue;
+			}
+
+			std::string filepath = watchedDirectories[event->wd] + "/" + event->name;
+
+			if (event->mask & IN_ISDIR)
+			{
+				addWatch(filepath);
+			}
+			else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+			{
+				notify(filepath);
+			}
+		}
+	}
+
+	close(fileDescriptor);
+}
+
+#else
+
+void FileWatcher::run()
+{
+	std::unordered_map<std::string, std::filesystem::file_time_type> modificationTimes;
+	bool firstScan = true;
+
+	// No native notification API here, so we compare modification times periodically.
+	while (m_Running)
+	{
+		std::error_code error;
+
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(m_Directory, error))
+		{
+			if (!entry.is_regular_file())
+			{
+				continue;
+			}
+
+			std::string filepath = entry.path().generic_string();
+			std::filesystem::file_time_type modificationTime = entry.last_write_time(error);
+
+			auto it = modificationTimes.find(filepath);
+
+			if (it == modificationTimes.end() || it->second != modificationTime)
+			{
+				if (!firstScan)
+				{
+					notify(filepath);
+				}
+
+				modificationTimes[filepath] = modificationTime;
+			}
+		}
+
+		firstScan = false;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+	}
+}
+
+#endif
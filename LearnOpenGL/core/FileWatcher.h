@@ -0,0 +1,39 @@
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Filepath.h"
+
+// Watches a directory tree on a background thread and collects the files that changed.
+//
+// It relies on inotify on Linux and on ReadDirectoryChangesW on Windows. On other platforms,
+// the files' modification times are polled instead. Changes are only accumulated, consumers
+// (e.g. the render thread, between frames) drain them with "pollChanges".
+class FileWatcher
+{
+public:
+	FileWatcher(const char* directory);
+	~FileWatcher();
+
+	std::vector<std::string> pollChanges();
+
+private:
+	std::string m_Directory;
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+
+	std::mutex m_Mutex;
+	std::unordered_set<std::string> m_ChangedFiles;
+
+	void run();
+	void notify(const std::string& filepath);
+};
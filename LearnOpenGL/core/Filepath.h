@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+#include <filesystem>
+
+// Lexically normal form with forward slashes, so that the same file always gets the same key
+// (e.g. in the shader program cache and in the file watcher's change set).
+inline std::string normalizeFilepath(const std::string& filepath)
+{
+	return std::filesystem::path(filepath).lexically_normal().generic_string();
+}
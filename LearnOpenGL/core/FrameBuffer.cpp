@@ -4,7 +4,9 @@ FrameBuffer::FrameBuffer(int width, int height, int numberOfColorBuffers, int co
 	: m_ID(), m_NumberOfColorBuffers(numberOfColorBuffers), m_ColorBuffers(), m_DepthAndStencilBuffer(), m_DepthAndStencilBufferType(depthAndStencilBufferType)
 {
 	glGenFramebuffers(1, &m_ID);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_ID);
+
+	ResourceTracker::track(ResourceTracker::Category::FRAMEBUFFER, m_ID);
 
 	// Note:
 	//
@@ -65,14 +67,16 @@ FrameBuffer::FrameBuffer(int width, int height, int numberOfColorBuffers, int co
 		std::cout << "[ERROR] FRAMEBUFFER: Framebuffer is not complete!" << std::endl;
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 FrameBuffer::FrameBuffer(int width, int height, std::vector<ColorBufferConfig> configurations, const BufferType& depthAndStencilBufferType, int samples)
 	: m_ID(), m_NumberOfColorBuffers(configurations.size()), m_ColorBuffers(), m_DepthAndStencilBuffer(), m_DepthAndStencilBufferType(depthAndStencilBufferType)
 {
 	glGenFramebuffers(1, &m_ID);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_ID);
+
+	ResourceTracker::track(ResourceTracker::Category::FRAMEBUFFER, m_ID);
 
 	int numberOfColorBuffers = configurations.size();
 
@@ -137,15 +141,19 @@ FrameBuffer::FrameBuffer(int width, int height, std::vector<ColorBufferConfig> c
 		std::cout << "[ERROR] FRAMEBUFFER: Framebuffer is not complete!" << std::endl;
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 FrameBuffer::~FrameBuffer()
 {
+	ResourceTracker::untrack(ResourceTracker::Category::FRAMEBUFFER, m_ID);
+
 	glDeleteFramebuffers(1, &m_ID);
 
 	for (unsigned int i = 0; i < m_NumberOfColorBuffers; i++)
 	{
+		ResourceTracker::untrack(ResourceTracker::Category::TEXTURE, m_ColorBuffers[i]);
+
 		glDeleteTextures(1, &m_ColorBuffers[i]);
 	}
 
@@ -154,10 +162,14 @@ FrameBuffer::~FrameBuffer()
 	switch (m_DepthAndStencilBufferType)
 	{
 	case FrameBuffer::BufferType::TEXTURE:
+		ResourceTracker::untrack(ResourceTracker::Category::TEXTURE, m_DepthAndStencilBuffer);
+
 		glDeleteTextures(1, &m_DepthAndStencilBuffer);
 		break;
 
 	case FrameBuffer::BufferType::RENDER:
+		ResourceTracker::untrack(ResourceTracker::Category::RENDERBUFFER, m_DepthAndStencilBuffer);
+
 		glDeleteRenderbuffers(1, &m_DepthAndStencilBuffer);
 		break;
 
@@ -166,22 +178,39 @@ FrameBuffer::~FrameBuffer()
 	}
 }
 
+FrameBuffer::FrameBuffer(FrameBuffer&& other) noexcept
+	: m_ID(), m_NumberOfColorBuffers(), m_ColorBuffers(), m_DepthAndStencilBuffer(), m_DepthAndStencilBufferType(BufferType::NONE)
+{
+	*this = std::move(other);
+}
+
+FrameBuffer& FrameBuffer::operator=(FrameBuffer&& other) noexcept
+{
+	// The previous buffers are deleted along with "other".
+	std::swap(m_ID, other.m_ID);
+	std::swap(m_NumberOfColorBuffers, other.m_NumberOfColorBuffers);
+	std::swap(m_ColorBuffers, other.m_ColorBuffers);
+	std::swap(m_DepthAndStencilBuffer, other.m_DepthAndStencilBuffer);
+	std::swap(m_DepthAndStencilBufferType, other.m_DepthAndStencilBufferType);
+
+	return *this;
+}
+
 void FrameBuffer::bind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_ID);
 }
 
 void FrameBuffer::unbind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void FrameBuffer::bindColorBuffer(int unit, int attachmentNumber)
 {
 	if (unit >= 0 && unit <= 15)
 	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_2D, m_ColorBuffers[attachmentNumber]);
+		GLStateCache::bindTexture(unit, GL_TEXTURE_2D, m_ColorBuffers[attachmentNumber]);
 	}
 	else
 	{
@@ -219,46 +248,46 @@ void FrameBuffer::attachTextureAsColorBuffer(int width, int height, int attachme
 			type = GL_FLOAT;
 		}
 
-		glBindTexture(GL_TEXTURE_2D, m_ColorBuffers[attachmentNumber]);
+		GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D, m_ColorBuffers[attachmentNumber]);
 
 		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
 
+		ResourceTracker::track(ResourceTracker::Category::TEXTURE, m_ColorBuffers[attachmentNumber], ResourceTracker::getTextureSize(internalFormat, width, height));
+
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clampMode);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clampMode);
 
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + attachmentNumber, GL_TEXTURE_2D, m_ColorBuffers[attachmentNumber], 0);
-
-		glBindTexture(GL_TEXTURE_2D, 0);
 	}
 	else
 	{
-		glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, m_ColorBuffers[attachmentNumber]);
+		GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D_MULTISAMPLE, m_ColorBuffers[attachmentNumber]);
 
 		glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, internalFormat, width, height, GL_TRUE);
 
+		ResourceTracker::track(ResourceTracker::Category::TEXTURE, m_ColorBuffers[attachmentNumber], ResourceTracker::getTextureSize(internalFormat, width, height) * samples);
+
 		glTexParameteri(GL_TEXTURE_2D_MULTISAMPLE, GL_TEXTURE_MIN_FILTER, filter);
 		glTexParameteri(GL_TEXTURE_2D_MULTISAMPLE, GL_TEXTURE_MAG_FILTER, filter);
 		glTexParameteri(GL_TEXTURE_2D_MULTISAMPLE, GL_TEXTURE_WRAP_S, clampMode);
 		glTexParameteri(GL_TEXTURE_2D_MULTISAMPLE, GL_TEXTURE_WRAP_T, clampMode);
 
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + attachmentNumber, GL_TEXTURE_2D_MULTISAMPLE, m_ColorBuffers[attachmentNumber], 0);
-
-		glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 	}
 }
 
 void FrameBuffer::attachTextureAsDepthAndStencilBuffer(int width, int height)
 {
 	glGenTextures(1, &m_DepthAndStencilBuffer);
-	glBindTexture(GL_TEXTURE_2D, m_DepthAndStencilBuffer);
+	GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D, m_DepthAndStencilBuffer);
 	
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+
+	ResourceTracker::track(ResourceTracker::Category::TEXTURE, m_DepthAndStencilBuffer, ResourceTracker::getTextureSize(GL_DEPTH24_STENCIL8, width, height));
 	
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_DepthAndStencilBuffer, 0);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void FrameBuffer::attachRenderBufferAsDepthAndStencilBuffer(int width, int height, int samples)
@@ -273,10 +302,14 @@ void FrameBuffer::attachRenderBufferAsDepthAndStencilBuffer(int width, int heigh
 	if (samples == 1)
 	{
 		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+		ResourceTracker::track(ResourceTracker::Category::RENDERBUFFER, m_DepthAndStencilBuffer, ResourceTracker::getTextureSize(GL_DEPTH24_STENCIL8, width, height));
 	}
 	else
 	{
 		glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH24_STENCIL8, width, height);
+
+		ResourceTracker::track(ResourceTracker::Category::RENDERBUFFER, m_DepthAndStencilBuffer, ResourceTracker::getTextureSize(GL_DEPTH24_STENCIL8, width, height) * 4);
 	}
 
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAndStencilBuffer);
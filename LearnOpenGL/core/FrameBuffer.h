@@ -1,10 +1,14 @@
 #pragma once
 
 #include <vector>
+#include <utility>
 #include <iostream>
 
 #include <glad/glad.h>
 
+#include "ResourceTracker.h"
+#include "GLStateCache.h"
+
 struct ColorBufferConfig
 {
 	int m_InternalFormat = GL_RGBA;
@@ -21,6 +25,12 @@ public:
 	FrameBuffer(int width, int height, std::vector<ColorBufferConfig> configurations, const BufferType& depthAndStencilBufferType = BufferType::RENDER, int samples = 1);
 	~FrameBuffer();
 
+	FrameBuffer(FrameBuffer&& other) noexcept;
+	FrameBuffer& operator=(FrameBuffer&& other) noexcept;
+
+	FrameBuffer(const FrameBuffer&) = delete;
+	FrameBuffer& operator=(const FrameBuffer&) = delete;
+
 	void bind();
 	void unbind();
 
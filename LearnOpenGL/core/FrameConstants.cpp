@@ -0,0 +1,44 @@
+#include "FrameConstants.h"
+
+FrameConstants::FrameConstants(StreamBuffer* streamBuffer, const int bindingPoint)
+	: m_Layout(), m_StreamBuffer(streamBuffer), m_BindingPoint(bindingPoint)
+{
+	// Same member order as the GLSL block.
+	m_ViewMatrixOffset              = m_Layout.add(Std140Layout::Type::MAT4);
+	m_ProjectionMatrixOffset        = m_Layout.add(Std140Layout::Type::MAT4);
+	m_InverseViewMatrixOffset       = m_Layout.add(Std140Layout::Type::MAT4);
+	m_InverseProjectionMatrixOffset = m_Layout.add(Std140Layout::Type::MAT4);
+	m_ViewportOffset                = m_Layout.add(Std140Layout::Type::VEC4);
+	m_CameraPositionOffset          = m_Layout.add(Std140Layout::Type::VEC3);
+	m_TimeOffset                    = m_Layout.add(Std140Layout::Type::FLOAT);
+
+	ShaderProgram::setGlobalUniformBlock("FrameConstants", bindingPoint);
+}
+
+FrameConstants::~FrameConstants()
+{
+}
+
+void FrameConstants::update(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const glm::vec3& cameraPosition, const glm::vec2& viewportSize, const float time)
+{
+	m_Layout.set(m_ViewMatrixOffset, viewMatrix);
+	m_Layout.set(m_ProjectionMatrixOffset, projectionMatrix);
+	m_Layout.set(m_InverseViewMatrixOffset, glm::inverse(viewMatrix));
+	m_Layout.set(m_InverseProjectionMatrixOffset, glm::inverse(projectionMatrix));
+	m_Layout.set(m_ViewportOffset, glm::vec4(viewportSize, 1.0f / viewportSize));
+	m_Layout.set(m_CameraPositionOffset, cameraPosition);
+	m_Layout.set(m_TimeOffset, time);
+
+	StreamBuffer::Allocation allocation = m_StreamBuffer->allocate(m_Layout.getSize(), StreamBuffer::getUniformOffsetAlignment());
+
+	if (!allocation.m_Data)
+	{
+		return;
+	}
+
+	std::memcpy(allocation.m_Data, m_Layout.getData(), m_Layout.getSize());
+
+	m_StreamBuffer->flush();
+
+	glBindBufferRange(GL_UNIFORM_BUFFER, m_BindingPoint, m_StreamBuffer->getID(), allocation.m_Offset, m_Layout.getSize());
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Std140Layout.h"
+#include "StreamBuffer.h"
+#include "ShaderProgram.h"
+
+// Per-frame constants shared by every pass (camera, projection, viewport and time).
+//
+// They're written once per frame into the stream buffer and bound at a fixed binding point, and
+// the "FrameConstants" block (see "scripts/include/frame_constants.glsl") is bound to it in
+// every program that declares it, when the program is linked.
+class FrameConstants
+{
+public:
+	FrameConstants(StreamBuffer* streamBuffer, const int bindingPoint);
+	~FrameConstants();
+
+	void update(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, const glm::vec3& cameraPosition, const glm::vec2& viewportSize, const float time);
+
+private:
+	Std140Layout m_Layout;
+	StreamBuffer* m_StreamBuffer;
+	int m_BindingPoint;
+
+	int m_ViewMatrixOffset, m_ProjectionMatrixOffset, m_InverseViewMatrixOffset, m_InverseProjectionMatrixOffset;
+	int m_ViewportOffset, m_CameraPositionOffset, m_TimeOffset;
+};
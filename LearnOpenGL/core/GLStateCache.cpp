@@ -0,0 +1,301 @@
+#include "GLStateCache.h"
+
+// Initial values of a new context.
+unsigned int GLStateCache::s_ProgramID = 0;
+unsigned int GLStateCache::s_VertexArrayID = 0;
+unsigned int GLStateCache::s_DrawFramebufferID = 0;
+unsigned int GLStateCache::s_ReadFramebufferID = 0;
+int GLStateCache::s_ActiveUnit = 0;
+unsigned int GLStateCache::s_Textures[GLStateCache::s_MaxTextureUnits][GLStateCache::s_NumberOfTextureTargets];
+std::unordered_map<unsigned int, bool> GLStateCache::s_Capabilities;
+unsigned int GLStateCache::s_BlendSourceFactor = GL_ONE;
+unsigned int GLStateCache::s_BlendDestinationFactor = GL_ZERO;
+unsigned int GLStateCache::s_DepthFunction = GL_LESS;
+unsigned int GLStateCache::s_DepthMask = GL_TRUE;
+unsigned int GLStateCache::s_CullFaceMode = GL_BACK;
+
+GLStateCache::Statistics GLStateCache::s_Statistics = {};
+GLStateCache::Statistics GLStateCache::s_LastStatistics = {};
+
+void GLStateCache::useProgram(const unsigned int programID)
+{
+	if (update(s_ProgramID, programID))
+	{
+		glUseProgram(programID);
+	}
+}
+
+void GLStateCache::bindVertexArray(const unsigned int vertexArrayID)
+{
+	if (update(s_VertexArrayID, vertexArrayID))
+	{
+		glBindVertexArray(vertexArrayID);
+	}
+}
+
+void GLStateCache::bindFramebuffer(const unsigned int target, const unsigned int framebufferID)
+{
+	bool changed = false;
+
+	switch (target)
+	{
+	case GL_FRAMEBUFFER:
+		// Both targets at once, only skipped when both already match.
+		if (s_DrawFramebufferID == framebufferID && s_ReadFramebufferID == framebufferID)
+		{
+			s_Statistics.m_SkippedCalls++;
+		}
+		else
+		{
+			s_DrawFramebufferID = framebufferID;
+			s_ReadFramebufferID = framebufferID;
+			s_Statistics.m_IssuedCalls++;
+			changed = true;
+		}
+		break;
+
+	case GL_DRAW_FRAMEBUFFER:
+		changed = update(s_DrawFramebufferID, framebufferID);
+		break;
+
+	case GL_READ_FRAMEBUFFER:
+		changed = update(s_ReadFramebufferID, framebufferID);
+		break;
+
+	default:
+		s_Statistics.m_IssuedCalls++;
+		changed = true;
+		break;
+	}
+
+	if (changed)
+	{
+		glBindFramebuffer(target, framebufferID);
+	}
+}
+
+void GLStateCache::bindTexture(const int unit, const unsigned int target, const unsigned int textureID)
+{
+	int targetIndex = getTargetIndex(target);
+	bool recorded = unit >= 0 && unit < s_MaxTextureUnits && targetIndex >= 0;
+
+	if (recorded && s_Textures[unit][targetIndex] == textureID)
+	{
+		s_Statistics.m_SkippedCalls++;
+
+		return;
+	}
+
+	if (s_ActiveUnit != unit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+
+		s_ActiveUnit = unit;
+		s_Statistics.m_IssuedCalls++;
+	}
+
+	glBindTexture(target, textureID);
+
+	if (recorded)
+	{
+		s_Textures[unit][targetIndex] = textureID;
+	}
+
+	s_Statistics.m_IssuedCalls++;
+}
+
+void GLStateCache::bindTextureForUpdate(const unsigned int target, const unsigned int textureID)
+{
+	bindTexture(s_UpdateUnit, target, textureID);
+
+	// The binding may have been skipped while another unit was active.
+	if (s_ActiveUnit != s_UpdateUnit)
+	{
+		glActiveTexture(GL_TEXTURE0 + s_UpdateUnit);
+
+		s_ActiveUnit = s_UpdateUnit;
+		s_Statistics.m_IssuedCalls++;
+	}
+}
+
+void GLStateCache::setEnabled(const unsigned int capability, const bool enabled)
+{
+	auto it = s_Capabilities.find(capability);
+
+	if (it != s_Capabilities.end() && it->second == enabled)
+	{
+		s_Statistics.m_SkippedCalls++;
+
+		return;
+	}
+
+	if (enabled)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+
+	s_Capabilities[capability] = enabled;
+	s_Statistics.m_IssuedCalls++;
+}
+
+bool GLStateCache::isEnabled(const unsigned int capability)
+{
+	auto it = s_Capabilities.find(capability);
+
+	if (it != s_Capabilities.end())
+	{
+		return it->second;
+	}
+
+	// Never set through the cache, so it still holds its initial value.
+	return capability == GL_DITHER || capability == GL_MULTISAMPLE;
+}
+
+void GLStateCache::setBlendFunc(const unsigned int sourceFactor, const unsigned int destinationFactor)
+{
+	if (s_BlendSourceFactor == sourceFactor && s_BlendDestinationFactor == destinationFactor)
+	{
+		s_Statistics.m_SkippedCalls++;
+
+		return;
+	}
+
+	glBlendFunc(sourceFactor, destinationFactor);
+
+	s_BlendSourceFactor = sourceFactor;
+	s_BlendDestinationFactor = destinationFactor;
+	s_Statistics.m_IssuedCalls++;
+}
+
+void GLStateCache::setDepthFunc(const unsigned int function)
+{
+	if (update(s_DepthFunction, function))
+	{
+		glDepthFunc(function);
+	}
+}
+
+void GLStateCache::setDepthMask(const bool enabled)
+{
+	if (update(s_DepthMask, enabled ? GL_TRUE : GL_FALSE))
+	{
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void GLStateCache::setCullFace(const unsigned int mode)
+{
+	if (update(s_CullFaceMode, mode))
+	{
+		glCullFace(mode);
+	}
+}
+
+void GLStateCache::forgetProgram(const unsigned int programID)
+{
+	if (s_ProgramID == programID)
+	{
+		s_ProgramID = s_Unknown;
+	}
+}
+
+void GLStateCache::forgetVertexArray(const unsigned int vertexArrayID)
+{
+	if (s_VertexArrayID == vertexArrayID)
+	{
+		s_VertexArrayID = s_Unknown;
+	}
+}
+
+void GLStateCache::forgetFramebuffer(const unsigned int framebufferID)
+{
+	if (s_DrawFramebufferID == framebufferID)
+	{
+		s_DrawFramebufferID = s_Unknown;
+	}
+
+	if (s_ReadFramebufferID == framebufferID)
+	{
+		s_ReadFramebufferID = s_Unknown;
+	}
+}
+
+void GLStateCache::forgetTexture(const unsigned int textureID)
+{
+	for (int i = 0; i < s_MaxTextureUnits; i++)
+	{
+		for (int j = 0; j < s_NumberOfTextureTargets; j++)
+		{
+			if (s_Textures[i][j] == textureID)
+			{
+				s_Textures[i][j] = s_Unknown;
+			}
+		}
+	}
+}
+
+void GLStateCache::invalidate()
+{
+	s_ProgramID = s_Unknown;
+	s_VertexArrayID = s_Unknown;
+	s_DrawFramebufferID = s_Unknown;
+	s_ReadFramebufferID = s_Unknown;
+	s_ActiveUnit = -1;
+
+	for (int i = 0; i < s_MaxTextureUnits; i++)
+	{
+		for (int j = 0; j < s_NumberOfTextureTargets; j++)
+		{
+			s_Textures[i][j] = s_Unknown;
+		}
+	}
+
+	s_Capabilities.clear();
+
+	s_BlendSourceFactor = s_Unknown;
+	s_BlendDestinationFactor = s_Unknown;
+	s_DepthFunction = s_Unknown;
+	s_DepthMask = s_Unknown;
+	s_CullFaceMode = s_Unknown;
+}
+
+void GLStateCache::beginFrame()
+{
+	s_LastStatistics = s_Statistics;
+	s_Statistics = {};
+}
+
+const GLStateCache::Statistics& GLStateCache::getStatistics()
+{
+	return s_LastStatistics;
+}
+
+bool GLStateCache::update(unsigned int& value, const unsigned int newValue)
+{
+	if (value == newValue)
+	{
+		s_Statistics.m_SkippedCalls++;
+
+		return false;
+	}
+
+	value = newValue;
+	s_Statistics.m_IssuedCalls++;
+
+	return true;
+}
+
+int GLStateCache::getTargetIndex(const unsigned int target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D:             return 0;
+	case GL_TEXTURE_CUBE_MAP:       return 1;
+	case GL_TEXTURE_2D_MULTISAMPLE: return 2;
+	default:                        return -1;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+// Shadow copy of the GL state that changes the most between draws. Every binding and
+// fixed-function state change of "core" and "util" goes through it.
+//
+// A call is only forwarded to the driver when it changes the recorded state, and the state
+// is never read back from the driver. Whatever changes it behind the cache's back must call
+// "invalidate", after which the next call of each kind is always issued.
+class GLStateCache
+{
+public:
+	struct Statistics
+	{
+		unsigned int m_IssuedCalls;
+		unsigned int m_SkippedCalls;
+	};
+
+	static void useProgram(const unsigned int programID);
+	static void bindVertexArray(const unsigned int vertexArrayID);
+	static void bindFramebuffer(const unsigned int target, const unsigned int framebufferID);
+	static void bindTexture(const int unit, const unsigned int target, const unsigned int textureID);
+
+	// Binds the texture on a unit reserved for it and makes that unit active, so that the
+	// following glTex* calls modify it without disturbing the textures bound for drawing.
+	static void bindTextureForUpdate(const unsigned int target, const unsigned int textureID);
+
+	static void setEnabled(const unsigned int capability, const bool enabled);
+	static bool isEnabled(const unsigned int capability);
+
+	static void setBlendFunc(const unsigned int sourceFactor, const unsigned int destinationFactor);
+	static void setDepthFunc(const unsigned int function);
+	static void setDepthMask(const bool enabled);
+	static void setCullFace(const unsigned int mode);
+
+	// Deleting a bound object unbinds it, and its name can be handed out again.
+	static void forgetProgram(const unsigned int programID);
+	static void forgetVertexArray(const unsigned int vertexArrayID);
+	static void forgetFramebuffer(const unsigned int framebufferID);
+	static void forgetTexture(const unsigned int textureID);
+
+	static void invalidate();
+
+	static void beginFrame();
+	static const Statistics& getStatistics(); // Of the last complete frame.
+
+	static const int s_MaxTextureUnits = 32;
+	static const int s_UpdateUnit = s_MaxTextureUnits - 1;
+
+private:
+	static const unsigned int s_Unknown = 0xFFFFFFFF;
+
+	// Texture targets whose bindings are recorded, the others are always issued.
+	static const int s_NumberOfTextureTargets = 3;
+
+	static unsigned int s_ProgramID, s_VertexArrayID, s_DrawFramebufferID, s_ReadFramebufferID;
+	static int s_ActiveUnit;
+	static unsigned int s_Textures[s_MaxTextureUnits][s_NumberOfTextureTargets];
+	static std::unordered_map<unsigned int, bool> s_Capabilities; // Unknown when missing.
+	static unsigned int s_BlendSourceFactor, s_BlendDestinationFactor, s_DepthFunction, s_DepthMask, s_CullFaceMode;
+
+	static Statistics s_Statistics, s_LastStatistics;
+
+	static bool update(unsigned int& value, const unsigned int newValue);
+	static int getTargetIndex(const unsigned int target);
+};
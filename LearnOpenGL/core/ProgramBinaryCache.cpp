@@ -0,0 +1,157 @@
+#include "ProgramBinaryCache.h"
+
+const char* ProgramBinaryCache::s_Directory = "cache/shaders";
+
+namespace
+{
+	const unsigned int c_Magic = 0x42474F4C; // "LOGB".
+	const unsigned int c_Version = 1;
+
+	struct BinaryHeader
+	{
+		unsigned int m_Magic;
+		unsigned int m_Version;
+		unsigned int m_Format;
+		unsigned int m_Length;
+	};
+
+	// 64-bit FNV-1a.
+	void hashBytes(unsigned long long& hash, const char* data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= (unsigned char)data[i];
+			hash *= 0x100000001B3ull;
+		}
+	}
+
+	void hashString(unsigned long long& hash, const std::string& data)
+	{
+		// The terminator separates consecutive strings, so "ab" + "c" differs from "a" + "bc".
+		hashBytes(hash, data.c_str(), data.size() + 1);
+	}
+
+	std::string getDriverString(GLenum name)
+	{
+		const GLubyte* value = glGetString(name);
+
+		return value ? (const char*)value : "";
+	}
+}
+
+bool ProgramBinaryCache::isSupported()
+{
+	static int numberOfFormats = -1;
+
+	if (numberOfFormats < 0)
+	{
+		numberOfFormats = 0;
+
+		if (GLAD_GL_ARB_get_program_binary)
+		{
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numberOfFormats);
+		}
+	}
+
+	return numberOfFormats > 0;
+}
+
+std::string ProgramBinaryCache::computeKey(const std::vector<std::string>& sources, const std::string& defines)
+{
+	static const std::string driver = getDriverString(GL_VENDOR) + "|" + getDriverString(GL_RENDERER) + "|" + getDriverString(GL_VERSION);
+
+	unsigned long long hash = 0xCBF29CE484222325ull;
+	char buffer[17];
+
+	hashString(hash, driver);
+	hashString(hash, defines);
+
+	for (const std::string& source : sources)
+	{
+		hashString(hash, source);
+	}
+
+	snprintf(buffer, sizeof(buffer), "%016llx", hash);
+
+	return buffer;
+}
+
+bool ProgramBinaryCache::load(unsigned int programID, const std::string& key)
+{
+	if (!isSupported())
+	{
+		return false;
+	}
+
+	std::ifstream file(getFilepath(key), std::ios::binary);
+	BinaryHeader header = {};
+
+	if (!file || !file.read((char*)&header, sizeof(header)))
+	{
+		return false;
+	}
+
+	if (header.m_Magic != c_Magic || header.m_Version != c_Version || header.m_Length == 0)
+	{
+		return false;
+	}
+
+	std::vector<char> binary(header.m_Length);
+
+	if (!file.read(binary.data(), header.m_Length))
+	{
+		return false;
+	}
+
+	int success;
+
+	glProgramBinary(programID, header.m_Format, binary.data(), header.m_Length);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+
+	// A rejected binary isn't an error, the caller just falls back to a compilation from source.
+	return success == GL_TRUE;
+}
+
+void ProgramBinaryCache::store(unsigned int programID, const std::string& key)
+{
+	if (!isSupported())
+	{
+		return;
+	}
+
+	int length = 0;
+
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(length);
+	BinaryHeader header = { c_Magic, c_Version, 0, 0 };
+
+	glGetProgramBinary(programID, length, &length, &header.m_Format, binary.data());
+
+	header.m_Length = length;
+
+	std::error_code error;
+	std::filesystem::create_directories(s_Directory, error);
+
+	std::ofstream file(getFilepath(key), std::ios::binary | std::ios::trunc);
+
+	if (!file)
+	{
+		std::cout << "[ERROR] PROGRAM BINARY CACHE: Failed to write \"" << getFilepath(key) << "\"." << std::endl;
+
+		return;
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), length);
+}
+
+std::string ProgramBinaryCache::getFilepath(const std::string& key)
+{
+	return std::string(s_Directory) + "/" + key + ".bin";
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+#include <glad/glad.h>
+
+// On-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary).
+//
+// Entries are keyed by a hash of every stage source, the injected defines and the driver's
+// vendor/renderer/version strings, so a driver update or any change in the GLSL code simply
+// misses the cache. Drivers are also free to reject a binary, which callers must handle by
+// compiling the program from source.
+class ProgramBinaryCache
+{
+public:
+	static bool isSupported();
+
+	static std::string computeKey(const std::vector<std::string>& sources, const std::string& defines);
+
+	static bool load(unsigned int programID, const std::string& key);
+	static void store(unsigned int programID, const std::string& key);
+
+private:
+	static const char* s_Directory;
+
+	static std::string getFilepath(const std::string& key);
+};
@@ -0,0 +1,143 @@
+#include "RenderQueue.h"
+
+RenderQueue::RenderQueue()
+	: m_Items(), m_TextureRanges(), m_Textures(), m_Entries(), m_SortBuffer()
+{
+}
+
+void RenderQueue::submit(DrawItem item, const TextureBinding* textures, const unsigned int numberOfTextures)
+{
+	m_Entries.push_back({ item.m_Key, (unsigned int)m_Items.size() });
+	m_TextureRanges.push_back({ (unsigned int)m_Textures.size(), numberOfTextures });
+	m_Textures.insert(m_Textures.end(), textures, textures + numberOfTextures);
+	m_Items.push_back(std::move(item));
+}
+
+void RenderQueue::flush()
+{
+	sort();
+
+	for (const SortEntry& entry : m_Entries)
+	{
+		DrawItem& item = m_Items[entry.m_Index];
+
+		if (!item.m_Program->isReady())
+		{
+			continue;
+		}
+
+		GLStateCache::useProgram(item.m_Program->getID());
+		GLStateCache::bindVertexArray(item.m_VertexArrayID);
+
+		const std::pair<unsigned int, unsigned int>& range = m_TextureRanges[entry.m_Index];
+
+		for (unsigned int i = range.first; i < range.first + range.second; i++)
+		{
+			GLStateCache::bindTexture(m_Textures[i].m_Unit, m_Textures[i].m_Target, m_Textures[i].m_ID);
+		}
+
+		item.m_Program->setUniformMatrix4fv(item.m_ModelMatrixHandle, item.m_ModelMatrix);
+
+		if (item.m_Setup)
+		{
+			item.m_Setup(item.m_Program);
+		}
+
+		if (item.m_Draw)
+		{
+			item.m_Draw();
+		}
+		else if (item.m_Indexed)
+		{
+			glDrawElements(item.m_Mode, item.m_Count, GL_UNSIGNED_INT, (void*)(item.m_First * sizeof(unsigned int)));
+		}
+		else
+		{
+			glDrawArrays(item.m_Mode, item.m_First, item.m_Count);
+		}
+	}
+
+	clear();
+}
+
+void RenderQueue::clear()
+{
+	m_Items.clear();
+	m_TextureRanges.clear();
+	m_Textures.clear();
+	m_Entries.clear();
+}
+
+size_t RenderQueue::getNumberOfItems() const
+{
+	return m_Items.size();
+}
+
+unsigned long long RenderQueue::makeKey(const unsigned int pass, const unsigned int programID, const unsigned int materialID, const unsigned int vertexArrayID, const float depth)
+{
+	unsigned long long quantizedDepth = (unsigned long long)(glm::clamp(depth, 0.0f, 1.0f) * 0xFFFFF);
+
+	return (unsigned long long)(pass & 0xF) << 60 |
+		(unsigned long long)(programID & 0xFFF) << 48 |
+		(unsigned long long)(materialID & 0xFFFF) << 32 |
+		(unsigned long long)(vertexArrayID & 0xFFF) << 20 |
+		quantizedDepth;
+}
+
+unsigned int RenderQueue::getMaterialID(const TextureBinding* textures, const unsigned int numberOfTextures)
+{
+	unsigned int hash = 0x811C9DC5; // 32-bit FNV-1a over the bound names, folded to 16 bits.
+
+	for (unsigned int i = 0; i < numberOfTextures; i++)
+	{
+		hash ^= textures[i].m_ID;
+		hash *= 0x01000193;
+	}
+
+	return numberOfTextures == 0 ? 0 : (hash ^ (hash >> 16)) & 0xFFFF;
+}
+
+void RenderQueue::sort()
+{
+	// Least significant digit radix sort, 8 bits per pass. It's stable, so equal keys keep
+	// their submission order.
+	size_t counts[8][256] = {};
+
+	for (const SortEntry& entry : m_Entries)
+	{
+		for (int digit = 0; digit < 8; digit++)
+		{
+			counts[digit][(entry.m_Key >> (digit * 8)) & 0xFF]++;
+		}
+	}
+
+	m_SortBuffer.resize(m_Entries.size());
+
+	for (int digit = 0; digit < 8 && !m_Entries.empty(); digit++)
+	{
+		int shift = digit * 8;
+
+		// Every key shares this digit (e.g. a single pass), the pass wouldn't move anything.
+		if (counts[digit][(m_Entries[0].m_Key >> shift) & 0xFF] == m_Entries.size())
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+
+		for (int i = 0; i < 256; i++)
+		{
+			size_t count = counts[digit][i];
+
+			counts[digit][i] = offset;
+			offset += count;
+		}
+
+		for (const SortEntry& entry : m_Entries)
+		{
+			m_SortBuffer[counts[digit][(entry.m_Key >> shift) & 0xFF]++] = entry;
+		}
+
+		m_Entries.swap(m_SortBuffer);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <functional>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "ShaderProgram.h"
+#include "GLStateCache.h"
+
+struct TextureBinding
+{
+	int m_Unit;
+	unsigned int m_Target;
+	unsigned int m_ID;
+};
+
+struct DrawItem
+{
+	unsigned long long m_Key; // See "RenderQueue::makeKey".
+
+	ShaderProgram* m_Program;
+	unsigned int m_VertexArrayID;
+
+	unsigned int m_Mode;
+	int m_First, m_Count; // Indices (unsigned int) when indexed, vertices otherwise.
+	bool m_Indexed;
+
+	glm::mat4 m_ModelMatrix;
+	UniformHandle m_ModelMatrixHandle; // The matrix is ignored while unresolved.
+	std::function<void(ShaderProgram*)> m_Setup; // Any other per-draw uniform, optional.
+	std::function<void()> m_Draw; // Replaces the draw call described above (e.g. a multi-draw), optional.
+};
+
+// Collects the draws of a pass (or a frame) and issues them ordered by their 64-bit sort key,
+// through the GL state cache, so that draws sharing a program, a material or a vertex array
+// follow each other and their binds are skipped.
+//
+// Key layout, from the most significant bits:
+//   pass (4) | program (12) | material (16) | vertex array (12) | depth (20)
+//
+// Items with equal keys keep their submission order.
+class RenderQueue
+{
+public:
+	RenderQueue();
+
+	void submit(DrawItem item, const TextureBinding* textures = nullptr, const unsigned int numberOfTextures = 0);
+	void flush();
+	void clear();
+
+	size_t getNumberOfItems() const;
+
+	// Depth is normalized, pass "1 - depth" to draw back to front (e.g. for blending).
+	static unsigned long long makeKey(const unsigned int pass, const unsigned int programID, const unsigned int materialID, const unsigned int vertexArrayID, const float depth);
+	static unsigned int getMaterialID(const TextureBinding* textures, const unsigned int numberOfTextures);
+
+private:
+	struct SortEntry
+	{
+		unsigned long long m_Key;
+		unsigned int m_Index;
+	};
+
+	std::vector<DrawItem> m_Items;
+	std::vector<std::pair<unsigned int, unsigned int>> m_TextureRanges; // First texture and count, per item.
+	std::vector<TextureBinding> m_Textures;
+
+	std::vector<SortEntry> m_Entries, m_SortBuffer; // Kept across frames, sorting doesn't allocate.
+
+	void sort();
+};
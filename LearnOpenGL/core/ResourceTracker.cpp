@@ -0,0 +1,123 @@
+#include "ResourceTracker.h"
+
+std::mutex ResourceTracker::s_Mutex;
+std::unordered_map<unsigned int, size_t> ResourceTracker::s_Objects[(int)Category::NUMBER_OF_CATEGORIES];
+size_t ResourceTracker::s_Bytes[(int)Category::NUMBER_OF_CATEGORIES] = {};
+
+void ResourceTracker::track(const Category category, const unsigned int id, const size_t bytes)
+{
+	if (id == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	size_t& objectBytes = s_Objects[(int)category][id];
+
+	s_Bytes[(int)category] += bytes - objectBytes;
+	objectBytes = bytes;
+}
+
+void ResourceTracker::untrack(const Category category, const unsigned int id)
+{
+	switch (category)
+	{
+	case Category::VERTEX_ARRAY: GLStateCache::forgetVertexArray(id); break;
+	case Category::TEXTURE:      GLStateCache::forgetTexture(id); break;
+	case Category::FRAMEBUFFER:  GLStateCache::forgetFramebuffer(id); break;
+	case Category::PROGRAM:      GLStateCache::forgetProgram(id); break;
+	default:                     break;
+	}
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	auto it = s_Objects[(int)category].find(id);
+
+	// Deleting the name 0 (e.g. of a moved-from wrapper) is a no-op in GL, here too.
+	if (it == s_Objects[(int)category].end())
+	{
+		return;
+	}
+
+	s_Bytes[(int)category] -= it->second;
+	s_Objects[(int)category].erase(it);
+}
+
+size_t ResourceTracker::getCount(const Category category)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+
+	return s_Objects[(int)category].size();
+}
+
+size_t ResourceTracker::getBytes(const Category category)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+
+	return s_Bytes[(int)category];
+}
+
+const char* ResourceTracker::getName(const Category category)
+{
+	switch (category)
+	{
+	case Category::BUFFER:       return "Buffers";
+	case Category::VERTEX_ARRAY: return "Vertex arrays";
+	case Category::TEXTURE:      return "Textures";
+	case Category::RENDERBUFFER: return "Renderbuffers";
+	case Category::FRAMEBUFFER:  return "Framebuffers";
+	case Category::PROGRAM:      return "Programs";
+	default:                     return "Unknown";
+	}
+}
+
+size_t ResourceTracker::getTextureSize(const int internalFormat, const int width, const int height, const bool mipmapped)
+{
+	size_t bitsPerTexel;
+
+	// Drivers usually pad three-component formats to four.
+	switch (internalFormat)
+	{
+	case GL_RED: case GL_R8:
+		bitsPerTexel = 8;
+		break;
+
+	case GL_RG: case GL_RG8:
+		bitsPerTexel = 16;
+		break;
+
+	case GL_RGB16F: case GL_RGBA16F:
+		bitsPerTexel = 64;
+		break;
+
+	case GL_RGB32F: case GL_RGBA32F:
+		bitsPerTexel = 128;
+		break;
+
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		bitsPerTexel = 4;
+		break;
+
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT: case GL_COMPRESSED_RG_RGTC2:
+		bitsPerTexel = 8;
+		break;
+
+	default: // RGB(A)8, sRGB(A)8, depth and depth/stencil formats.
+		bitsPerTexel = 32;
+		break;
+	}
+
+	size_t size = (size_t)width * height * bitsPerTexel / 8;
+
+	// A full mip chain adds a third of the base level.
+	return mipmapped ? size * 4 / 3 : size;
+}
+
+void ResourceTracker::report()
+{
+	for (int i = 0; i < (int)Category::NUMBER_OF_CATEGORIES; i++)
+	{
+		Category category = (Category)i;
+
+		std::cout << "[INFO] RESOURCE TRACKER: " << getName(category) << ": " << getCount(category) << " (" << getBytes(category) / 1024 << " KB)." << std::endl;
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <cstddef>
+#include <iostream>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+#include "GLStateCache.h"
+
+// Bookkeeping of the live GL objects and the (estimated) memory they hold, per category.
+//
+// Every wrapper reports the names it creates with "track" and the ones it deletes with
+// "untrack". Tracking a live name again replaces its size, e.g. when a texture is specified
+// again. Counts that keep growing while scenes are reloaded point at a leak.
+//
+// Untracked names are also forgotten by the GL state cache, since GL unbinds deleted objects.
+class ResourceTracker
+{
+public:
+	enum class Category { BUFFER, VERTEX_ARRAY, TEXTURE, RENDERBUFFER, FRAMEBUFFER, PROGRAM, NUMBER_OF_CATEGORIES };
+
+	static void track(const Category category, const unsigned int id, const size_t bytes = 0);
+	static void untrack(const Category category, const unsigned int id);
+
+	static size_t getCount(const Category category);
+	static size_t getBytes(const Category category);
+	static const char* getName(const Category category);
+
+	static size_t getTextureSize(const int internalFormat, const int width, const int height, const bool mipmapped = false);
+
+	static void report();
+
+private:
+	static std::mutex s_Mutex;
+	static std::unordered_map<unsigned int, size_t> s_Objects[(int)Category::NUMBER_OF_CATEGORIES];
+	static size_t s_Bytes[(int)Category::NUMBER_OF_CATEGORIES];
+};
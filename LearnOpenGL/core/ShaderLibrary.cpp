@@ -0,0 +1,136 @@
+#include "ShaderLibrary.h"
+
+ShaderLibrary::ShaderLibrary()
+	: m_Programs(), m_PendingPrograms(), m_FileWatcher()
+{
+	// Let the driver pick as many compiler threads as it wants.
+	if (GLAD_GL_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+	else if (GLAD_GL_ARB_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+	}
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+	delete m_FileWatcher; // Stops its thread.
+
+	for (ShaderProgram* program : m_Programs)
+	{
+		delete program;
+	}
+}
+
+ShaderProgram* ShaderLibrary::load(const char* vertexShaderFilepath, const char* fragmentShaderFilepath, const ShaderDefines& defines)
+{
+	return add({ { GL_VERTEX_SHADER, vertexShaderFilepath }, { GL_FRAGMENT_SHADER, fragmentShaderFilepath } }, defines);
+}
+
+ShaderProgram* ShaderLibrary::load(const char* vertexShaderFilepath, const char* geometryShaderFilepath, const char* fragmentShaderFilepath, const ShaderDefines& defines)
+{
+	return add({ { GL_VERTEX_SHADER, vertexShaderFilepath }, { GL_GEOMETRY_SHADER, geometryShaderFilepath }, { GL_FRAGMENT_SHADER, fragmentShaderFilepath } }, defines);
+}
+
+void ShaderLibrary::watch(const char* directory)
+{
+	delete m_FileWatcher;
+
+	m_FileWatcher = new FileWatcher(directory);
+}
+
+void ShaderLibrary::update()
+{
+	if (m_FileWatcher)
+	{
+		reloadChangedPrograms();
+	}
+
+	for (unsigned int i = 0; i < m_PendingPrograms.size(); )
+	{
+		if (m_PendingPrograms[i]->poll())
+		{
+			m_PendingPrograms[i] = m_PendingPrograms.back();
+			m_PendingPrograms.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+void ShaderLibrary::wait()
+{
+	for (ShaderProgram* program : m_PendingPrograms)
+	{
+		program->wait();
+	}
+
+	m_PendingPrograms.clear();
+}
+
+bool ShaderLibrary::isReady() const
+{
+	for (ShaderProgram* program : m_Programs)
+	{
+		if (program->getStatus() == ShaderProgram::Status::PENDING)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+ShaderProgram* ShaderLibrary::add(const std::vector<ShaderStage>& stages, const ShaderDefines& defines)
+{
+	std::string key;
+
+	for (const ShaderStage& stage : stages)
+	{
+		key += normalizeFilepath(stage.m_Filepath) + "|";
+	}
+
+	key += ShaderProgram::getPermutationKey(defines);
+
+	auto it = m_Permutations.find(key);
+
+	if (it != m_Permutations.end())
+	{
+		return it->second;
+	}
+
+	ShaderProgram* program = new ShaderProgram(stages, defines, true);
+
+	m_Permutations[key] = program;
+	m_Programs.push_back(program);
+	m_PendingPrograms.push_back(program);
+
+	return program;
+}
+
+void ShaderLibrary::reloadChangedPrograms()
+{
+	for (const std::string& filepath : m_FileWatcher->pollChanges())
+	{
+		for (ShaderProgram* program : m_Programs)
+		{
+			if (!program->dependsOn(filepath))
+			{
+				continue;
+			}
+
+			std::cout << "[INFO] SHADER LIBRARY: Reloading a program using \"" << filepath << "\"." << std::endl;
+
+			program->reload();
+
+			if (std::find(m_PendingPrograms.begin(), m_PendingPrograms.end(), program) == m_PendingPrograms.end())
+			{
+				m_PendingPrograms.push_back(program);
+			}
+		}
+	}
+}
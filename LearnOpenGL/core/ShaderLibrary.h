@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+#include "FileWatcher.h"
+#include "ShaderProgram.h"
+
+// Owns a set of shader programs and compiles them as a batch: every program is submitted
+// (compiled and linked) up front and their statuses are only queried afterwards, so the
+// driver can overlap the work instead of stalling once per shader stage. With
+// GL_KHR_parallel_shader_compile, "update" never blocks and programs become ready
+// over the next frames.
+//
+// Programs are cached per permutation: loading the same stages with the same defines twice
+// returns the program compiled the first time.
+//
+// When a directory is watched, programs whose sources changed on disk are recompiled the
+// same way and swapped in once linked. A program that fails to compile keeps running
+// its previous version.
+class ShaderLibrary
+{
+public:
+	ShaderLibrary();
+	~ShaderLibrary();
+
+	ShaderProgram* load(const char* vertexShaderFilepath, const char* fragmentShaderFilepath, const ShaderDefines& defines = {});
+	ShaderProgram* load(const char* vertexShaderFilepath, const char* geometryShaderFilepath, const char* fragmentShaderFilepath, const ShaderDefines& defines = {});
+
+	void watch(const char* directory);
+
+	void update();
+	void wait();
+
+	bool isReady() const;
+
+private:
+	std::vector<ShaderProgram*> m_Programs;
+	std::vector<ShaderProgram*> m_PendingPrograms;
+	std::unordered_map<std::string, ShaderProgram*> m_Permutations; // Stage filepaths and permutation key to program.
+
+	FileWatcher* m_FileWatcher;
+
+	ShaderProgram* add(const std::vector<ShaderStage>& stages, const ShaderDefines& defines);
+	void reloadChangedPrograms();
+};
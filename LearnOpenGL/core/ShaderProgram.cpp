@@ -1,149 +1,188 @@
 #include "ShaderProgram.h"
 
-ShaderProgram::ShaderProgram(const char* vertexShaderFilepath, const char* fragmentShaderFilepath) : m_ID()
-{
-	int success;
-	char infoLog[512];
+std::unordered_map<std::string, int> ShaderProgram::s_GlobalUniformBlockBindings;
 
-	unsigned int vertexShaderID = createShader(vertexShaderFilepath, GL_VERTEX_SHADER);
-	unsigned int fragmentShaderID = createShader(fragmentShaderFilepath, GL_FRAGMENT_SHADER);
-
-	m_ID = glCreateProgram();
+ShaderProgram::ShaderProgram(const char* vertexShaderFilepath, const char* fragmentShaderFilepath)
+	: ShaderProgram({ { GL_VERTEX_SHADER, vertexShaderFilepath }, { GL_FRAGMENT_SHADER, fragmentShaderFilepath } })
+{
+}
 
-	glAttachShader(m_ID, vertexShaderID);
-	glAttachShader(m_ID, fragmentShaderID);
+ShaderProgram::ShaderProgram(const char* vertexShaderFilepath, const char* geometryShaderFilepath, const char* fragmentShaderFilepath)
+	: ShaderProgram({ { GL_VERTEX_SHADER, vertexShaderFilepath }, { GL_GEOMETRY_SHADER, geometryShaderFilepath }, { GL_FRAGMENT_SHADER, fragmentShaderFilepath } })
+{
+}
 
-	glLinkProgram(m_ID);
-	glGetProgramiv(m_ID, GL_LINK_STATUS, &success);
+ShaderProgram::ShaderProgram(const std::vector<ShaderStage>& stages, const ShaderDefines& defines, const bool deferred)
+	: m_ID(), m_PendingID(), m_Status(Status::PENDING), m_Stages(stages), m_Defines(defines)
+{
+	submit();
 
-	if (!success)
+	// Deferred programs are finalized later on (see "ShaderLibrary"),
+	// so that several of them can be compiled and linked in parallel.
+	if (!deferred)
 	{
-		glGetProgramInfoLog(m_ID, 512, NULL, infoLog);
-
-		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
+		finalize();
 	}
-
-	glDeleteShader(vertexShaderID);
-	glDeleteShader(fragmentShaderID);
 }
 
-ShaderProgram::ShaderProgram(const char* vertexShaderFilepath, const char* geometryShaderFilepath, const char* fragmentShaderFilepath) : m_ID()
+ShaderProgram::~ShaderProgram()
 {
-	int success;
-	char infoLog[512];
-
-	unsigned int vertexShaderID = createShader(vertexShaderFilepath, GL_VERTEX_SHADER);
-	unsigned int geometryShaderID = createShader(geometryShaderFilepath, GL_GEOMETRY_SHADER);
-	unsigned int fragmentShaderID = createShader(fragmentShaderFilepath, GL_FRAGMENT_SHADER);
-
-	m_ID = glCreateProgram();
-
-	glAttachShader(m_ID, vertexShaderID);
-	glAttachShader(m_ID, geometryShaderID);
-	glAttachShader(m_ID, fragmentShaderID);
-
-	glLinkProgram(m_ID);
-	glGetProgramiv(m_ID, GL_LINK_STATUS, &success);
-
-	if (!success)
+	for (unsigned int shaderID : m_PendingShaders)
 	{
-		glGetProgramInfoLog(m_ID, 512, NULL, infoLog);
-
-		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
+		glDeleteShader(shaderID);
 	}
 
-	glDeleteShader(vertexShaderID);
-	glDeleteShader(geometryShaderID);
-	glDeleteShader(fragmentShaderID);
-}
+	ResourceTracker::untrack(ResourceTracker::Category::PROGRAM, m_PendingID);
+	ResourceTracker::untrack(ResourceTracker::Category::PROGRAM, m_ID);
 
-ShaderProgram::~ShaderProgram()
-{
+	glDeleteProgram(m_PendingID);
 	glDeleteProgram(m_ID);
 }
 
 void ShaderProgram::bind()
 {
-	glUseProgram(m_ID);
+	GLStateCache::useProgram(m_ID);
 }
 
 void ShaderProgram::unbind()
 {
-	glUseProgram(0);
+	GLStateCache::useProgram(0);
+}
+
+UniformHandle ShaderProgram::getUniformHandle(const char* uniformName)
+{
+	UniformHandle handle;
+
+	for (unsigned int i = 0; i < m_HandleNames.size(); i++)
+	{
+		if (m_HandleNames[i] == uniformName)
+		{
+			handle.m_Slot = i;
+
+			return handle;
+		}
+	}
+
+	handle.m_Slot = (int)m_HandleNames.size();
+
+	// Handles requested while the program is still compiling get resolved by the reflection.
+	m_HandleNames.push_back(uniformName);
+	m_HandleLocations.push_back(m_Status == Status::READY ? getUniformLocation(uniformName) : -1);
+
+	return handle;
 }
 
 void ShaderProgram::setUniform1i(const char* uniformName, const int& data)
 {
-	int uniformLocation = glGetUniformLocation(m_ID, uniformName);
+	int uniformLocation = getUniformLocation(uniformName);
 
 	if (uniformLocation > -1)
 	{
 		glUniform1i(uniformLocation, data);
 	}
-	else
-	{
-		std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform \"" << uniformName << "\"" << std::endl;
-	}
 }
 
 void ShaderProgram::setUniform1f(const char* uniformName, const float& data)
 {
-	int uniformLocation = glGetUniformLocation(m_ID, uniformName);
+	int uniformLocation = getUniformLocation(uniformName);
 
 	if (uniformLocation > -1)
 	{
 		glUniform1f(uniformLocation, data);
 	}
-	else
-	{
-		std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform \"" << uniformName << "\"" << std::endl;
-	}
 }
 
 void ShaderProgram::setUniform3f(const char* uniformName, const glm::vec3& data)
 {
-	int uniformLocation = glGetUniformLocation(m_ID, uniformName);
+	int uniformLocation = getUniformLocation(uniformName);
 
 	if (uniformLocation > -1)
 	{
 		glUniform3f(uniformLocation, data.x, data.y, data.z);
 	}
-	else
-	{
-		std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform \"" << uniformName << "\"" << std::endl;
-	}
 }
 
 void ShaderProgram::setUniform4f(const char* uniformName, const glm::vec4& data)
 {
-	int uniformLocation = glGetUniformLocation(m_ID, uniformName);
+	int uniformLocation = getUniformLocation(uniformName);
 
 	if (uniformLocation > -1)
 	{
 		glUniform4f(uniformLocation, data.x, data.y, data.z, data.w);
 	}
-	else
-	{
-		std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform \"" << uniformName << "\"" << std::endl;
-	}
 }
 
 void ShaderProgram::setUniformMatrix4fv(const char* uniformName, const glm::mat4& data)
 {
-	int uniformLocation = glGetUniformLocation(m_ID, uniformName);
+	int uniformLocation = getUniformLocation(uniformName);
 
 	if (uniformLocation > -1)
 	{
 		glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(data));
 	}
-	else
+}
+
+void ShaderProgram::setUniform1i(const UniformHandle& handle, const int& data)
+{
+	int uniformLocation = getUniformLocation(handle);
+
+	if (uniformLocation > -1)
 	{
-		std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform \"" << uniformName << "\"" << std::endl;
+		glUniform1i(uniformLocation, data);
+	}
+}
+
+void ShaderProgram::setUniform1f(const UniformHandle& handle, const float& data)
+{
+	int uniformLocation = getUniformLocation(handle);
+
+	if (uniformLocation > -1)
+	{
+		glUniform1f(uniformLocation, data);
+	}
+}
+
+void ShaderProgram::setUniform3f(const UniformHandle& handle, const glm::vec3& data)
+{
+	int uniformLocation = getUniformLocation(handle);
+
+	if (uniformLocation > -1)
+	{
+		glUniform3f(uniformLocation, data.x, data.y, data.z);
+	}
+}
+
+void ShaderProgram::setUniform4f(const UniformHandle& handle, const glm::vec4& data)
+{
+	int uniformLocation = getUniformLocation(handle);
+
+	if (uniformLocation > -1)
+	{
+		glUniform4f(uniformLocation, data.x, data.y, data.z, data.w);
+	}
+}
+
+void ShaderProgram::setUniformMatrix4fv(const UniformHandle& handle, const glm::mat4& data)
+{
+	int uniformLocation = getUniformLocation(handle);
+
+	if (uniformLocation > -1)
+	{
+		glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(data));
 	}
 }
 
 void ShaderProgram::setUniformBlock(const char* uniformBlockName, const int bindingPoint)
 {
+	// Bindings are part of the program object, so they're remembered for the next links
+	// (reloads) and applied once the program is ready if it's still compiling.
+	m_UniformBlockBindings[uniformBlockName] = bindingPoint;
+
+	if (m_Status != Status::READY)
+	{
+		return;
+	}
+
 	int uniformBlockLocation = glGetUniformBlockIndex(m_ID, uniformBlockName);
 
 	if (uniformBlockLocation > -1)
@@ -156,39 +195,456 @@ void ShaderProgram::setUniformBlock(const char* uniformBlockName, const int bind
 	}
 }
 
-const std::string ShaderProgram::readShaderSource(const char* filepath)
+void ShaderProgram::setSamplerUnit(const char* samplerName, const int unit)
+{
+	auto it = m_SamplerUnits.find(samplerName);
+
+	if (it != m_SamplerUnits.end() && it->second == unit)
+	{
+		return;
+	}
+
+	// Unlike plain uniforms, sampler units are set once and survive reloads.
+	m_SamplerUnits[samplerName] = unit;
+
+	if (m_Status == Status::READY)
+	{
+		bind();
+		setUniform1i(samplerName, unit);
+	}
+}
+
+unsigned int ShaderProgram::getID() const
+{
+	return m_ID;
+}
+
+const std::string ShaderProgram::readShaderSource(const char* filepath, std::vector<std::string>& files)
+{
+	std::string source;
+
+	files.clear();
+
+	if (!preprocessShaderSource(normalizeFilepath(filepath), source, files))
+	{
+		std::cout << "[ERROR] SHADER PROGRAM: Failed to preprocess \"" << filepath << "\"." << std::endl;
+	}
+
+	return source;
+}
+
+bool ShaderProgram::preprocessShaderSource(const std::string& filepath, std::string& source, std::vector<std::string>& files)
 {
 	std::ifstream fileStream(filepath);
-	std::stringstream stringBuffer;
 
-	stringBuffer << fileStream.rdbuf();
+	if (!fileStream)
+	{
+		std::cout << "[ERROR] SHADER PROGRAM: Failed to open \"" << filepath << "\"." << std::endl;
+
+		return false;
+	}
+
+	// Files are identified by their index in "files", which is also their source string
+	// number in "#line" directives, so compilation errors point to the right file and line.
+	const int fileIndex = (int)files.size();
+	const std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+
+	std::string line;
+	int lineNumber = 0;
+	bool success = true;
+
+	files.push_back(filepath);
+
+	while (std::getline(fileStream, line))
+	{
+		size_t start = line.find_first_not_of(" \t");
+
+		lineNumber++;
+
+		if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+		{
+			size_t open = line.find('"', start), close = line.find('"', open + 1);
+
+			if (open == std::string::npos || close == std::string::npos)
+			{
+				std::cout << "[ERROR] SHADER PROGRAM: Malformed #include in \"" << filepath << "\" at line " << lineNumber << "." << std::endl;
+
+				success = false;
+				continue;
+			}
+
+			std::string includedFilepath = normalizeFilepath((directory / line.substr(open + 1, close - open - 1)).generic_string());
 
-	return stringBuffer.str();
+			// Every file is included once per stage, so headers don't need include guards.
+			if (std::find(files.begin(), files.end(), includedFilepath) == files.end())
+			{
+				source += "#line 1 " + std::to_string(files.size()) + "\n";
+				success &= preprocessShaderSource(includedFilepath, source, files);
+				source += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+			}
+
+			continue;
+		}
+
+		source += line + "\n";
+
+		// Injected defines must follow the "#version" directive of the main file.
+		if (fileIndex == 0 && start != std::string::npos && line.compare(start, 8, "#version") == 0)
+		{
+			for (const auto& define : m_Defines)
+			{
+				source += "#define " + define.first + " " + define.second + "\n";
+			}
+
+			source += "#line " + std::to_string(lineNumber + 1) + " 0\n";
+		}
+	}
+
+	return success;
 }
 
-const unsigned int ShaderProgram::createShader(const char* shaderFilepath, int shaderType)
+void ShaderProgram::setGlobalUniformBlock(const char* uniformBlockName, const int bindingPoint)
 {
-	int success;
-	char infoLog[512];
+	// Only programs linked from now on pick it up, so it must be set before loading them.
+	s_GlobalUniformBlockBindings[uniformBlockName] = bindingPoint;
+}
 
-	const std::string shaderSource = readShaderSource(shaderFilepath);
+std::string ShaderProgram::getPermutationKey(const ShaderDefines& defines)
+{
+	std::string key;
+
+	// Defines are sorted by name, so the same set always yields the same key.
+	for (const auto& define : defines)
+	{
+		key += define.first + "=" + define.second + ";";
+	}
+
+	return key;
+}
+
+const unsigned int ShaderProgram::createShader(const std::string& shaderSource, int shaderType)
+{
 	const char* shaderCode = shaderSource.c_str();
 
 	unsigned int shaderID = glCreateShader(shaderType);
 
+	// The compile status is only queried in "finalize", which allows the driver
+	// to compile this shader in the background in the meantime.
 	glShaderSource(shaderID, 1, &shaderCode, NULL);
 	glCompileShader(shaderID);
-	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
 
-	if (!success)
+	return shaderID;
+}
+
+void ShaderProgram::submit()
+{
+	std::vector<std::string> sources;
+
+	m_Dependencies.clear();
+	m_StageFiles.resize(m_Stages.size());
+
+	for (unsigned int i = 0; i < m_Stages.size(); i++)
+	{
+		sources.push_back(readShaderSource(m_Stages[i].m_Filepath.c_str(), m_StageFiles[i]));
+
+		// Programs are reloaded when any of their included files changes too.
+		m_Dependencies.insert(m_StageFiles[i].begin(), m_StageFiles[i].end());
+	}
+
+	m_CacheKey = ProgramBinaryCache::computeKey(sources, getPermutationKey(m_Defines));
+	m_PendingID = glCreateProgram();
+
+	ResourceTracker::track(ResourceTracker::Category::PROGRAM, m_PendingID);
+
+	// Skip the whole compilation if the driver accepts a binary from a previous run.
+	if (ProgramBinaryCache::load(m_PendingID, m_CacheKey))
+	{
+		finalize();
+
+		return;
+	}
+
+	for (unsigned int i = 0; i < m_Stages.size(); i++)
+	{
+		unsigned int shaderID = createShader(sources[i], m_Stages[i].m_Type);
+
+		glAttachShader(m_PendingID, shaderID);
+
+		m_PendingShaders.push_back(shaderID);
+	}
+
+	if (ProgramBinaryCache::isSupported())
+	{
+		glProgramParameteri(m_PendingID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	glLinkProgram(m_PendingID);
+}
+
+void ShaderProgram::finalize()
+{
+	int success;
+	char infoLog[512];
+
+	if (m_PendingID == 0)
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i < m_PendingShaders.size(); i++)
+	{
+		glGetShaderiv(m_PendingShaders[i], GL_COMPILE_STATUS, &success);
+
+		if (!success)
+		{
+			glGetShaderInfoLog(m_PendingShaders[i], 512, NULL, infoLog);
+
+			std::cout << "[ERROR] SHADER PROGRAM: Compilation of \"" << m_Stages[i].m_Filepath << "\" failed!\n" << infoLog;
+
+			for (unsigned int j = 0; j < m_StageFiles[i].size(); j++)
+			{
+				std::cout << "  Source " << j << ": \"" << m_StageFiles[i][j] << "\"\n";
+			}
+
+			std::cout << std::endl;
+		}
+	}
+
+	glGetProgramiv(m_PendingID, GL_LINK_STATUS, &success);
+
+	if (success)
 	{
-		glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+		// Swap the new program in, handles and uniform locations follow it.
+		ResourceTracker::untrack(ResourceTracker::Category::PROGRAM, m_ID);
+
+		glDeleteProgram(m_ID);
+
+		m_ID = m_PendingID;
+		m_Status = Status::READY;
 
-		std::cout << "[ERROR] SHADER PROGRAM: Compilation failed!\n" << infoLog << std::endl;
+		reflectUniforms();
+		bindUniformBlocks();
+		bindSamplerUnits();
 
+		if (!m_PendingShaders.empty()) // Otherwise, it was loaded from the cache.
+		{
+			ProgramBinaryCache::store(m_ID, m_CacheKey);
+		}
+	}
+	else
+	{
+		glGetProgramInfoLog(m_PendingID, 512, NULL, infoLog);
+
+		std::cout << "[ERROR] SHADER PROGRAM: Linkage failed!\n" << infoLog << std::endl;
+
+		// A failed reload keeps the previous program running.
+		if (m_Status == Status::PENDING)
+		{
+			m_Status = Status::FAILED;
+		}
+	}
+
+	for (unsigned int shaderID : m_PendingShaders)
+	{
+		glDetachShader(m_PendingID, shaderID);
 		glDeleteShader(shaderID);
-		return 0;
 	}
 
-	return shaderID;
+	if (m_ID != m_PendingID)
+	{
+		ResourceTracker::untrack(ResourceTracker::Category::PROGRAM, m_PendingID);
+
+		glDeleteProgram(m_PendingID);
+	}
+
+	m_PendingID = 0;
+	m_PendingShaders.clear();
+}
+
+void ShaderProgram::reload()
+{
+	// Drop a reload that may still be in flight, its sources are outdated anyway.
+	for (unsigned int shaderID : m_PendingShaders)
+	{
+		glDeleteShader(shaderID);
+	}
+
+	ResourceTracker::untrack(ResourceTracker::Category::PROGRAM, m_PendingID);
+
+	glDeleteProgram(m_PendingID);
+
+	m_PendingID = 0;
+	m_PendingShaders.clear();
+
+	submit();
+}
+
+bool ShaderProgram::poll()
+{
+	if (m_PendingID != 0 && isCompletionAvailable())
+	{
+		finalize();
+	}
+
+	return m_PendingID == 0;
+}
+
+void ShaderProgram::wait()
+{
+	finalize();
+}
+
+bool ShaderProgram::isReady() const
+{
+	return m_Status == Status::READY;
+}
+
+bool ShaderProgram::dependsOn(const std::string& filepath) const
+{
+	return m_Dependencies.count(normalizeFilepath(filepath)) > 0;
+}
+
+const ShaderProgram::Status& ShaderProgram::getStatus() const
+{
+	return m_Status;
+}
+
+bool ShaderProgram::isCompletionAvailable()
+{
+	// Without the extension, there is no way to know whether the driver is done
+	// without blocking, so we report it as done and let "finalize" wait for it.
+	if (!GLAD_GL_KHR_parallel_shader_compile && !GLAD_GL_ARB_parallel_shader_compile)
+	{
+		return true;
+	}
+
+	int completed = GL_FALSE;
+
+	glGetProgramiv(m_PendingID, GL_COMPLETION_STATUS_KHR, &completed);
+
+	return completed == GL_TRUE;
+}
+
+void ShaderProgram::reflectUniforms()
+{
+	int numberOfUniforms = 0, maxNameLength = 0;
+
+	glGetProgramiv(m_ID, GL_ACTIVE_UNIFORMS, &numberOfUniforms);
+	glGetProgramiv(m_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<char> nameBuffer(maxNameLength + 1);
+
+	m_UniformLocations.clear();
+	m_MissingUniforms.clear();
+
+	for (int i = 0; i < numberOfUniforms; i++)
+	{
+		int size, length;
+		unsigned int type;
+
+		glGetActiveUniform(m_ID, i, (int)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+		std::string uniformName(nameBuffer.data(), length);
+		int uniformLocation = glGetUniformLocation(m_ID, uniformName.c_str());
+
+		if (uniformLocation < 0) // Members of uniform blocks don't have a location.
+		{
+			continue;
+		}
+
+		m_UniformLocations[uniformName] = uniformLocation;
+
+		// Arrays of basic types are reported only once, as "name[0]", so we register
+		// the bare name and every other element of the array explicitly.
+		if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+		{
+			std::string baseName = uniformName.substr(0, uniformName.size() - 3);
+
+			m_UniformLocations[baseName] = uniformLocation;
+
+			for (int j = 1; j < size; j++)
+			{
+				std::string elementName = baseName + "[" + std::to_string(j) + "]";
+
+				m_UniformLocations[elementName] = glGetUniformLocation(m_ID, elementName.c_str());
+			}
+		}
+	}
+
+	// Handles survive relinking, we only need to resolve their locations again.
+	for (unsigned int i = 0; i < m_HandleNames.size(); i++)
+	{
+		m_HandleLocations[i] = getUniformLocation(m_HandleNames[i].c_str());
+	}
+}
+
+void ShaderProgram::bindUniformBlocks()
+{
+	// Global blocks are optional, a program only gets bound to the ones it declares.
+	for (const auto& binding : s_GlobalUniformBlockBindings)
+	{
+		unsigned int uniformBlockLocation = glGetUniformBlockIndex(m_ID, binding.first.c_str());
+
+		if (uniformBlockLocation != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(m_ID, uniformBlockLocation, binding.second);
+		}
+	}
+
+	for (const auto& binding : m_UniformBlockBindings)
+	{
+		unsigned int uniformBlockLocation = glGetUniformBlockIndex(m_ID, binding.first.c_str());
+
+		if (uniformBlockLocation != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(m_ID, uniformBlockLocation, binding.second);
+		}
+		else
+		{
+			std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform block \"" << binding.first << "\"" << std::endl;
+		}
+	}
+}
+
+void ShaderProgram::bindSamplerUnits()
+{
+	if (m_SamplerUnits.empty())
+	{
+		return;
+	}
+
+	bind();
+
+	for (const auto& samplerUnit : m_SamplerUnits)
+	{
+		setUniform1i(samplerUnit.first.c_str(), samplerUnit.second);
+	}
+}
+
+int ShaderProgram::getUniformLocation(const char* uniformName)
+{
+	auto it = m_UniformLocations.find(uniformName);
+
+	if (it != m_UniformLocations.end())
+	{
+		return it->second;
+	}
+
+	// Report each missing uniform only once instead of on every frame.
+	if (m_MissingUniforms.insert(uniformName).second)
+	{
+		std::cout << "[ERROR] SHADER PROGRAM: Failed to get location of uniform \"" << uniformName << "\"" << std::endl;
+	}
+
+	return -1;
+}
+
+int ShaderProgram::getUniformLocation(const UniformHandle& handle) const
+{
+	if (handle.m_Slot < 0 || handle.m_Slot >= (int)m_HandleLocations.size())
+	{
+		return -1;
+	}
+
+	return m_HandleLocations[handle.m_Slot];
 }
\ No newline at end of file
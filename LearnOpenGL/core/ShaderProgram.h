@@ -1,8 +1,15 @@
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <glad/glad.h>
 
@@ -10,27 +17,108 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "Filepath.h"
+#include "ProgramBinaryCache.h"
+#include "ResourceTracker.h"
+#include "GLStateCache.h"
+
+// Pre-resolved reference to a uniform of a specific program. It indexes a per-program
+// location table that is refreshed on every link, so setting a uniform through a handle
+// costs no string work nor any driver-side name lookup.
+struct UniformHandle
+{
+	int m_Slot = -1;
+};
+
+struct ShaderStage
+{
+	int m_Type;
+	std::string m_Filepath;
+};
+
+// Preprocessor definitions injected right after the "#version" directive of every stage.
+// Each distinct set of defines produces a distinct program (a permutation).
+using ShaderDefines = std::map<std::string, std::string>;
+
 class ShaderProgram
 {
 public:
+	enum class Status { PENDING, READY, FAILED };
+
 	ShaderProgram(const char* vertexShaderFilepath, const char* fragmentShaderFilepath);
 	ShaderProgram(const char* vertexShaderFilepath, const char* geometryShaderFilepath, const char* fragmentShaderFilepath);
+	ShaderProgram(const std::vector<ShaderStage>& stages, const ShaderDefines& defines = {}, const bool deferred = false);
 	~ShaderProgram();
 
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator=(const ShaderProgram&) = delete;
+
 	void bind();
 	void unbind();
 
+	bool poll();
+	void wait();
+	void reload();
+
+	bool isReady() const;
+	bool dependsOn(const std::string& filepath) const;
+	const Status& getStatus() const;
+
+	UniformHandle getUniformHandle(const char* uniformName);
+
 	void setUniform1i(const char* uniformName, const int& data);
 	void setUniform1f(const char* uniformName, const float& data);
 	void setUniform3f(const char* uniformName, const glm::vec3& data);
 	void setUniform4f(const char* uniformName, const glm::vec4& data);
 	void setUniformMatrix4fv(const char* uniformName, const glm::mat4& data);
 
+	void setUniform1i(const UniformHandle& handle, const int& data);
+	void setUniform1f(const UniformHandle& handle, const float& data);
+	void setUniform3f(const UniformHandle& handle, const glm::vec3& data);
+	void setUniform4f(const UniformHandle& handle, const glm::vec4& data);
+	void setUniformMatrix4fv(const UniformHandle& handle, const glm::mat4& data);
+
 	void setUniformBlock(const char* uniformBlockName, const int bindingPoint);
+	void setSamplerUnit(const char* samplerName, const int unit);
+
+	unsigned int getID() const;
+
+	static std::string getPermutationKey(const ShaderDefines& defines);
+	static void setGlobalUniformBlock(const char* uniformBlockName, const int bindingPoint);
 
 private:
-	unsigned int m_ID;
+	static std::unordered_map<std::string, int> s_GlobalUniformBlockBindings; // Bound in every program declaring them.
+
+	unsigned int m_ID, m_PendingID; // The pending program replaces the current one once linked.
+	Status m_Status;
+
+	std::vector<ShaderStage> m_Stages;
+	std::vector<std::vector<std::string>> m_StageFiles; // Main file and includes of each stage.
+	ShaderDefines m_Defines;
+	std::vector<unsigned int> m_PendingShaders;
+	std::string m_CacheKey;
+	std::unordered_set<std::string> m_Dependencies; // Normalized filepaths of every source.
+
+	std::unordered_map<std::string, int> m_UniformLocations; // Filled by reflection after each link.
+	std::unordered_set<std::string> m_MissingUniforms; // Names already reported as missing.
+
+	std::vector<std::string> m_HandleNames;
+	std::vector<int> m_HandleLocations;
+
+	std::unordered_map<std::string, int> m_UniformBlockBindings; // Applied again after each link.
+	std::unordered_map<std::string, int> m_SamplerUnits; // Same.
+
+	const std::string readShaderSource(const char* filepath, std::vector<std::string>& files);
+	bool preprocessShaderSource(const std::string& filepath, std::string& source, std::vector<std::string>& files);
+	const unsigned int createShader(const std::string& shaderSource, int shaderType);
+
+	void submit();
+	void finalize();
+	bool isCompletionAvailable();
 
-	const std::string readShaderSource(const char* filepath);
-	const unsigned int createShader(const char* shaderFilepath, int shaderType);
-};
\ No newline at end of file
+	void reflectUniforms();
+	void bindUniformBlocks();
+	void bindSamplerUnits();
+	int getUniformLocation(const char* uniformName);
+	int getUniformLocation(const UniformHandle& handle) const;
+};
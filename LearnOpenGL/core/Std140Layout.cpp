@@ -0,0 +1,104 @@
+#include "Std140Layout.h"
+
+namespace
+{
+	int alignTo(int offset, int alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+}
+
+Std140Layout::Std140Layout() : m_Data(), m_End(0)
+{
+}
+
+int Std140Layout::add(const Type type, const int count)
+{
+	int alignment = 16, size = 16;
+
+	switch (type)
+	{
+		case Type::INT:
+		case Type::FLOAT: alignment = 4;  size = 4;  break;
+		case Type::VEC2:  alignment = 8;  size = 8;  break;
+		case Type::VEC3:  alignment = 16; size = 12; break;
+		case Type::VEC4:  alignment = 16; size = 16; break;
+		case Type::MAT4:  alignment = 16; size = 64; break;
+	}
+
+	// Array elements are rounded up to the size of a vec4.
+	if (count > 1)
+	{
+		alignment = 16;
+		size = alignTo(size, 16) * count;
+	}
+
+	int offset = alignTo(m_End, alignment);
+
+	m_End = offset + size;
+
+	// The size of a block is rounded up to the alignment of a vec4 too.
+	m_Data.resize(alignTo(m_End, 16), 0);
+
+	return offset;
+}
+
+void Std140Layout::set(const int offset, const int& data)
+{
+	write(offset, &data, sizeof(int));
+}
+
+void Std140Layout::set(const int offset, const float& data)
+{
+	write(offset, &data, sizeof(float));
+}
+
+void Std140Layout::set(const int offset, const glm::vec2& data)
+{
+	write(offset, glm::value_ptr(data), sizeof(glm::vec2));
+}
+
+void Std140Layout::set(const int offset, const glm::vec3& data)
+{
+	write(offset, glm::value_ptr(data), sizeof(glm::vec3));
+}
+
+void Std140Layout::set(const int offset, const glm::vec4& data)
+{
+	write(offset, glm::value_ptr(data), sizeof(glm::vec4));
+}
+
+void Std140Layout::set(const int offset, const glm::mat4& data)
+{
+	write(offset, glm::value_ptr(data), sizeof(glm::mat4));
+}
+
+void Std140Layout::set(const int offset, const std::vector<glm::vec3>& data)
+{
+	for (unsigned int i = 0; i < data.size(); i++)
+	{
+		write(offset + i * 16, glm::value_ptr(data[i]), sizeof(glm::vec3));
+	}
+}
+
+const void* Std140Layout::getData() const
+{
+	return m_Data.data();
+}
+
+int Std140Layout::getSize() const
+{
+	return (int)m_Data.size();
+}
+
+void Std140Layout::write(const int offset, const void* data, const int size)
+{
+	if (offset < 0 || offset + size > (int)m_Data.size())
+	{
+		std::cout << "[ERROR] STD140 LAYOUT: Write of " << size << " bytes at offset " << offset << " is out of bounds." << std::endl;
+
+		return;
+	}
+
+	std::memcpy(m_Data.data() + offset, data, size);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// CPU-side copy of a uniform block laid out with the std140 rules, uploaded to a
+// "UniformBuffer" in a single call.
+//
+// Members are added in the same order as they're declared in the GLSL block, "add" returns
+// their byte offset which is then used to write their values. Scalars are aligned to 4 bytes,
+// vec2 to 8, vec3 and vec4 to 16, and every array element (or matrix column) is padded to 16.
+class Std140Layout
+{
+public:
+	enum class Type { INT, FLOAT, VEC2, VEC3, VEC4, MAT4 };
+
+	Std140Layout();
+
+	int add(const Type type, const int count = 1);
+
+	void set(const int offset, const int& data);
+	void set(const int offset, const float& data);
+	void set(const int offset, const glm::vec2& data);
+	void set(const int offset, const glm::vec3& data);
+	void set(const int offset, const glm::vec4& data);
+	void set(const int offset, const glm::mat4& data);
+	void set(const int offset, const std::vector<glm::vec3>& data);
+
+	const void* getData() const;
+	int getSize() const;
+
+private:
+	std::vector<unsigned char> m_Data;
+	int m_End; // End of the last member, the data itself is padded to a vec4.
+
+	void write(const int offset, const void* data, const int size);
+};
@@ -0,0 +1,162 @@
+#include "StreamBuffer.h"
+
+StreamBuffer::StreamBuffer(const int regionSize, const int numberOfRegions)
+	: m_ID(), m_RegionSize(regionSize), m_NumberOfRegions(numberOfRegions), m_Persistent(GLAD_GL_ARB_buffer_storage != 0), m_Data(), m_Shadow(),
+	  m_Fences(numberOfRegions, nullptr), m_Region(0), m_Head(0), m_FlushedHead(0), m_OverflowReported(false)
+{
+	const int size = m_RegionSize * m_NumberOfRegions;
+
+	glGenBuffers(1, &m_ID);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+
+	if (m_Persistent)
+	{
+		// Coherent, so writes are visible to the GPU without flushing them explicitly.
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+
+		m_Data = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+
+		if (!m_Data)
+		{
+			std::cout << "[ERROR] STREAM BUFFER: Failed to map the buffer persistently, falling back to a CPU-side copy." << std::endl;
+
+			// Immutable storage can't be specified again, hence the new buffer object.
+			glDeleteBuffers(1, &m_ID);
+			glGenBuffers(1, &m_ID);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+
+			m_Persistent = false;
+		}
+	}
+
+	if (!m_Persistent)
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+		m_Shadow.resize(size);
+		m_Data = m_Shadow.data();
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	ResourceTracker::track(ResourceTracker::Category::BUFFER, m_ID, size);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (GLsync fence : m_Fences)
+	{
+		glDeleteSync(fence);
+	}
+
+	if (m_Persistent)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_ID);
+
+	glDeleteBuffers(1, &m_ID);
+}
+
+void StreamBuffer::beginFrame()
+{
+	GLsync& fence = m_Fences[m_Region];
+
+	// Only blocks when the CPU is more than "m_NumberOfRegions" frames ahead of the GPU.
+	if (fence)
+	{
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+		{
+		}
+
+		glDeleteSync(fence);
+
+		fence = nullptr;
+	}
+
+	m_Head = m_Region * m_RegionSize;
+	m_FlushedHead = m_Head;
+}
+
+void StreamBuffer::endFrame()
+{
+	flush();
+
+	m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_Region = (m_Region + 1) % m_NumberOfRegions;
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(const int size, const int alignment)
+{
+	int offset = (m_Head + alignment - 1) / alignment * alignment;
+
+	if (offset + size > (m_Region + 1) * m_RegionSize)
+	{
+		if (!m_OverflowReported)
+		{
+			std::cout << "[ERROR] STREAM BUFFER: Region of " << m_RegionSize << " bytes is too small for this frame." << std::endl;
+
+			m_OverflowReported = true;
+		}
+
+		return { nullptr, -1 };
+	}
+
+	m_Head = offset + size;
+
+	return { m_Data + offset, offset };
+}
+
+void StreamBuffer::flush()
+{
+	if (m_Persistent || m_FlushedHead == m_Head)
+	{
+		return;
+	}
+
+	// The fence of the region guarantees the GPU doesn't read this range anymore,
+	// so there is no need for the driver to synchronize the mapping.
+	const int size = m_Head - m_FlushedHead;
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+
+	void* data = glMapBufferRange(GL_COPY_WRITE_BUFFER, m_FlushedHead, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+
+	if (data)
+	{
+		std::memcpy(data, m_Data + m_FlushedHead, size);
+
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	m_FlushedHead = m_Head;
+}
+
+bool StreamBuffer::isPersistent() const
+{
+	return m_Persistent;
+}
+
+unsigned int StreamBuffer::getID() const
+{
+	return m_ID;
+}
+
+int StreamBuffer::getUniformOffsetAlignment()
+{
+	static int alignment = 0;
+
+	if (alignment == 0)
+	{
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	}
+
+	return alignment;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include "ResourceTracker.h"
+
+// Ring buffer for data that is written every frame (text quads, per-frame uniforms, instance
+// data...). Writers sub-allocate from it, so there is one buffer object for all of them.
+//
+// The buffer is split into one region per frame in flight, each region being guarded by a fence:
+// a region is only written again once the GPU finished reading it, so writes never stall on the
+// driver's implicit synchronization. With ARB_buffer_storage, the buffer is persistently mapped
+// and written in place. Otherwise, writes go to a CPU-side copy which is copied to the buffer
+// through an unsynchronized mapping on "flush".
+class StreamBuffer
+{
+public:
+	struct Allocation
+	{
+		void* m_Data;
+		int m_Offset; // From the start of the buffer object, -1 if the allocation failed.
+	};
+
+	StreamBuffer(const int regionSize, const int numberOfRegions = 3);
+	~StreamBuffer();
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	void beginFrame();
+	void endFrame();
+
+	Allocation allocate(const int size, const int alignment = 16);
+	void flush();
+
+	bool isPersistent() const;
+	unsigned int getID() const;
+
+	static int getUniformOffsetAlignment();
+
+private:
+	unsigned int m_ID;
+	int m_RegionSize, m_NumberOfRegions;
+	bool m_Persistent;
+
+	unsigned char* m_Data; // Mapped memory, or the CPU-side copy.
+	std::vector<unsigned char> m_Shadow;
+
+	std::vector<GLsync> m_Fences;
+	int m_Region, m_Head, m_FlushedHead;
+	bool m_OverflowReported;
+};
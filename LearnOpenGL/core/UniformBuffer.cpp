@@ -6,13 +6,29 @@ UniformBuffer::UniformBuffer(const int size) : m_ID()
 	glBindBuffer(GL_UNIFORM_BUFFER, m_ID);
 	glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STATIC_DRAW);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	ResourceTracker::track(ResourceTracker::Category::BUFFER, m_ID, size);
 }
 
 UniformBuffer::~UniformBuffer()
 {
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_ID);
+
 	glDeleteBuffers(1, &m_ID);
 }
 
+UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept : m_ID(other.m_ID)
+{
+	other.m_ID = 0;
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept
+{
+	std::swap(m_ID, other.m_ID);
+
+	return *this;
+}
+
 void UniformBuffer::bind()
 {
 	glBindBuffer(GL_UNIFORM_BUFFER, m_ID);
@@ -36,4 +52,9 @@ void UniformBuffer::link(const int bindingPoint, const int offset, const int siz
 void UniformBuffer::update(const int offset, const int size, const void* data)
 {
 	glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
+
+void UniformBuffer::update(const Std140Layout& layout)
+{
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, layout.getSize(), layout.getData());
 }
\ No newline at end of file
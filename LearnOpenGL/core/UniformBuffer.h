@@ -1,13 +1,24 @@
 #pragma once
 
+#include <utility>
+
 #include <glad/glad.h>
 
+#include "Std140Layout.h"
+#include "ResourceTracker.h"
+
 class UniformBuffer
 {
 public:
 	UniformBuffer(const int size);
 	~UniformBuffer();
 
+	UniformBuffer(UniformBuffer&& other) noexcept;
+	UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+
 	void bind();
 	void unbind();
 
@@ -15,6 +26,7 @@ public:
 	void link(const int bindingPoint, const int offset, const int size);
 
 	void update(const int offset, const int size, const void* data);
+	void update(const Std140Layout& layout);
 
 private:
 	unsigned int m_ID;
@@ -4,6 +4,8 @@ VertexArray::VertexArray() : m_ID()
 {
 	glGenVertexArrays(1, &m_ID);
 
+	ResourceTracker::track(ResourceTracker::Category::VERTEX_ARRAY, m_ID);
+
 	// There is no reason to bind the VAO now...
 	// 
 	// glBindVertexArray(m_ID);
@@ -11,17 +13,37 @@ VertexArray::VertexArray() : m_ID()
 
 VertexArray::~VertexArray()
 {
+	ResourceTracker::untrack(ResourceTracker::Category::VERTEX_ARRAY, m_ID);
+
 	glDeleteVertexArrays(1, &m_ID);
 }
 
+VertexArray::VertexArray(VertexArray&& other) noexcept : m_ID(other.m_ID)
+{
+	other.m_ID = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	// The previous name is deleted along with "other".
+	std::swap(m_ID, other.m_ID);
+
+	return *this;
+}
+
+unsigned int VertexArray::getID() const
+{
+	return m_ID;
+}
+
 void VertexArray::bind()
 {
-	glBindVertexArray(m_ID);
+	GLStateCache::bindVertexArray(m_ID);
 }
 
 void VertexArray::unbind()
 {
-	glBindVertexArray(0);
+	GLStateCache::bindVertexArray(0);
 }
 
 void VertexArray::setVertexAttribute(unsigned int index, int size, int type, bool normalized, unsigned int stride, void* pointer, int divisor)
@@ -1,16 +1,29 @@
 #pragma once
 
+#include <utility>
+
 #include <glad/glad.h>
 
+#include "ResourceTracker.h"
+#include "GLStateCache.h"
+
 class VertexArray
 {
 public:
 	VertexArray();
 	~VertexArray();
 
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+
 	void bind();
 	void unbind();
 
+	unsigned int getID() const;
+
 	void setVertexAttribute(unsigned int index, int size, int type, bool normalized, unsigned int stride, void* pointer, int divisor = 0);
 	static int retrieveMaxVertexAttributes();
 
@@ -6,13 +6,29 @@ VertexBuffer::VertexBuffer(const void* vertices, const int size) : m_ID()
 	glBindBuffer(GL_ARRAY_BUFFER, m_ID);
 	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	ResourceTracker::track(ResourceTracker::Category::BUFFER, m_ID, size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_ID);
+
 	glDeleteBuffers(1, &m_ID);
 }
 
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept : m_ID(other.m_ID)
+{
+	other.m_ID = 0;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+	std::swap(m_ID, other.m_ID);
+
+	return *this;
+}
+
 void VertexBuffer::bind()
 {
 	glBindBuffer(GL_ARRAY_BUFFER, m_ID);
@@ -1,13 +1,23 @@
 #pragma once
 
+#include <utility>
+
 #include <glad/glad.h>
 
+#include "ResourceTracker.h"
+
 class VertexBuffer
 {
 public:
 	VertexBuffer(const void* vertices, const int size);
 	~VertexBuffer();
 
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+
 	void bind();
 	void unbind();
 
@@ -21,12 +21,26 @@
 #include "core/ShaderProgram.h"
 #include "core/FrameBuffer.h"
 #include "core/UniformBuffer.h"
+#include "core/Std140Layout.h"
+#include "core/ShaderLibrary.h"
+#include "core/FrameConstants.h"
+#include "core/StreamBuffer.h"
+#include "core/ResourceTracker.h"
+#include "core/GLStateCache.h"
+#include "core/RenderQueue.h"
 
 #include "util/Camera.h"
 #include "util/Texture.h"
+#include "util/TextureManager.h"
+#include "util/TextureCompressor.h"
 #include "util/CubeMap.h"
 #include "util/DepthMap.h"
 #include "util/TextRenderer.h"
+#include "util/Frustum.h"
+#include "util/BoundingVolumeHierarchy.h"
+#include "util/OcclusionCuller.h"
+#include "util/SceneGraph.h"
+#include "util/EntityRegistry.h"
 
 #include "util/object/Model.h"
 
@@ -43,6 +57,7 @@ float g_FieldOfView       = 45.0f;
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos);
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
 
@@ -63,14 +78,26 @@ glm::mat4      g_ProjectionMatrix = glm::perspective(glm::radians(g_FieldOfView)
 glm::mat4      g_UIProjectionMatrix = glm::ortho(0.0f, (float)g_WindowWidth, 0.0f, (float)g_WindowHeight);
 Camera*        g_MainCamera;
 
+ShaderLibrary* g_ShaderLibrary;
+RenderQueue*   g_RenderQueue;
+FrameConstants* g_FrameConstants;
+StreamBuffer*  g_StreamBuffer;
+
 ShaderProgram* g_DeferredGPassSP;
 ShaderProgram* g_SSAOPassSP;
 ShaderProgram* g_SSAOBlurPassSP;
 ShaderProgram* g_DeferredLPassSP;
+ShaderProgram* g_DeferredLPassUnlitSP;
 ShaderProgram* g_ForwardRenderingSP;
 
 ShaderProgram* g_RenderQuadSP;
 
+UniformHandle  g_GPassModelMatrix;
+UniformHandle  g_GPassInversedNormals;
+
+UniformHandle  g_ForwardModelMatrix;
+UniformHandle  g_ForwardLightColor;
+
 ShaderProgram* g_TextRendererSP;
 
 VertexArray*   g_QuadVAO;
@@ -83,6 +110,17 @@ FrameBuffer*   g_GBufferFB;
 FrameBuffer*   g_SSAOFB;
 FrameBuffer*   g_SSAOBlurFB;
 
+OcclusionCuller* g_OcclusionCuller; // Fed with the G-buffer depth.
+
+SceneGraph*    g_SceneGraph;
+unsigned int   g_ContainerNode, g_RoomNode, g_LightNode;
+
+EntityRegistry* g_Registry; // Drawn entities and lights, they follow the scene graph nodes.
+const int       g_MaxPointLights = 1; // See "N_POINT_LIGHTS" in the lighting pass.
+Entity          g_LightEntity; // Drawn in the forward pass, tinted by its own "LightSource".
+Entity          g_PickedEntity = EntityRegistry::s_NullEntity; // Under the cursor on the last left click.
+
+TextureManager* g_TextureManager;
 Texture*       g_ContainerTex;
 Texture*       g_ContainerSpecMap;
 Texture*       g_SSAONoiseTex;
@@ -92,14 +130,87 @@ TextRenderer*  g_TextRenderer;
 std::vector<glm::vec3> g_SSAOKernel;
 std::vector<glm::vec3> g_SSAONoise;
 
+
+// SSAO settings, the kernel lives in a uniform buffer that is only updated when they change.
+const int      g_SSAOMaxKernelSize      = 64;
+const int      g_SSAOKernelBindingPoint = 1;
+int            g_SSAOKernelSize         = 64;
+float          g_SSAORadius             = 0.5f;
+float          g_SSAOBias               = 0.025f;
+bool           g_SSAOKernelChanged      = true; // The samples depend on the size only.
+bool           g_SSAOParametersChanged  = true; // Radius and bias.
+
+Std140Layout*  g_SSAOKernelLayout;
+UniformBuffer* g_SSAOKernelUBO;
+int            g_SSAOSamplesOffset, g_SSAOKernelSizeOffset, g_SSAORadiusOffset, g_SSAOBiasOffset;
+
 glm::vec3 g_LightPosition = glm::vec3(2.0f, 4.0f, 2.0f);
-glm::vec3 g_LightColor = glm::vec3(0.25f, 0.25f, 0.75f);
+
+// Uniforms of "uLights[i]" in the lighting pass.
+struct PointLightUniforms
+{
+    UniformHandle m_Position, m_Color, m_Constant, m_Linear, m_Quadratic, m_Radius;
+};
+
+PointLightUniforms g_PointLightUniforms[g_MaxPointLights];
+UniformHandle      g_LPassProcessAllLightSources, g_LPassViewPos;
 
 float simpleLerp(float a, float b, float f)
 {
     return a + f * (b - a);
 }
 
+void updateSSAOKernel()
+{
+    // Default seed, a given kernel size always gets the same samples.
+    std::uniform_real_distribution<float> randomFloats(0.0f, 1.0f); // Generates random floats between 0.0 and 1.0.
+    std::default_random_engine generator;
+
+    g_SSAOKernel.clear();
+
+    // The samples are distributed according to the kernel size, so the kernel is generated again when it changes.
+    for (int i = 0; i < g_SSAOKernelSize; i++)
+    {
+        glm::vec3 sample(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator));
+        float scale = float(i) / float(g_SSAOKernelSize);
+
+        // Scale samples s.t. they're more aligned to center of kernel.
+        scale = simpleLerp(0.1f, 1.0f, scale * scale);
+
+        sample = glm::normalize(sample);
+        sample *= randomFloats(generator);
+        sample *= scale;
+
+        g_SSAOKernel.push_back(sample);
+    }
+
+    g_SSAOKernelLayout->set(g_SSAOSamplesOffset, g_SSAOKernel);
+    g_SSAOKernelLayout->set(g_SSAOKernelSizeOffset, g_SSAOKernelSize);
+    g_SSAOKernelLayout->set(g_SSAORadiusOffset, g_SSAORadius);
+    g_SSAOKernelLayout->set(g_SSAOBiasOffset, g_SSAOBias);
+
+    g_SSAOKernelUBO->bind();
+    g_SSAOKernelUBO->update(*g_SSAOKernelLayout);
+    g_SSAOKernelUBO->unbind();
+
+    g_SSAOKernelChanged = false;
+    g_SSAOParametersChanged = false;
+}
+
+// Only rewrites the radius and the bias, the samples stay as they are.
+void updateSSAOParameters()
+{
+    g_SSAOKernelLayout->set(g_SSAORadiusOffset, g_SSAORadius);
+    g_SSAOKernelLayout->set(g_SSAOBiasOffset, g_SSAOBias);
+
+    g_SSAOKernelUBO->bind();
+    g_SSAOKernelUBO->update(g_SSAORadiusOffset, sizeof(float), &g_SSAORadius);
+    g_SSAOKernelUBO->update(g_SSAOBiasOffset, sizeof(float), &g_SSAOBias);
+    g_SSAOKernelUBO->unbind();
+
+    g_SSAOParametersChanged = false;
+}
+
 void setup()
 {
     float quadVertices[] = {
@@ -160,23 +271,11 @@ void setup()
         -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f  // bottom-left
     };
 
-    std::uniform_real_distribution<float> randomFloats(0.0f, 1.0f); // Generates random floats between 0.0 and 1.0.
+    std::uniform_real_distribution<float> randomFloats(0.0f, 1.0f);
     std::default_random_engine generator;
 
-    for (unsigned int i = 0; i < 64; i++)
-    {
-        glm::vec3 sample(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator));
-        float scale = float(i) / 64.0f;
-
-        // Scale samples s.t. they're more aligned to center of kernel.
-        scale = simpleLerp(0.1f, 1.0f, scale * scale);
-
-        sample = glm::normalize(sample);
-        sample *= randomFloats(generator);
-        sample *= scale;
-
-        g_SSAOKernel.push_back(sample);
-    }
+    // Skips the draws of the largest kernel (4 per sample), so the noise doesn't replay its samples.
+    generator.discard(4 * g_SSAOMaxKernelSize);
 
     for (unsigned int i = 0; i < 16; i++)
     {
@@ -186,16 +285,77 @@ void setup()
     }
 
     g_MainCamera = new Camera(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    // The scene's transforms, the world matrices are recomputed by "update" only when they change.
+    g_SceneGraph = new SceneGraph();
+
+    g_ContainerNode = g_SceneGraph->addNode(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -6.5f, 0.0f)), SceneGraph::s_NoParent, "Container");
+    g_RoomNode = g_SceneGraph->addNode(glm::scale(glm::mat4(1.0f), glm::vec3(7.5f, 7.5f, 7.5f)), SceneGraph::s_NoParent, "Room");
+    g_LightNode = g_SceneGraph->addNode(glm::scale(glm::translate(glm::mat4(1.0f), g_LightPosition), glm::vec3(0.125f)), SceneGraph::s_NoParent, "Light");
         
-    g_DeferredGPassSP = new ShaderProgram("scripts/17_ds_geometry_pass_vs.glsl", "scripts/17_ds_geometry_pass_fs.glsl");
-    g_SSAOPassSP = new ShaderProgram("scripts/19_ssao_pass_vs.glsl", "scripts/19_ssao_pass_fs.glsl");
-    g_SSAOBlurPassSP = new ShaderProgram("scripts/19_ssao_pass_vs.glsl", "scripts/19_ssao_blur_pass_fs.glsl");
-    g_DeferredLPassSP = new ShaderProgram("scripts/17_ds_lighting_pass_vs.glsl", "scripts/17_ds_lighting_pass_fs.glsl");
-    g_ForwardRenderingSP = new ShaderProgram("scripts/17_forward_rendering_vs.glsl", "scripts/17_forward_rendering_fs.glsl");
+    // Bound to every program declaring the "FrameConstants" block, so it must exist before loading them.
+    g_StreamBuffer = new StreamBuffer(1024 * 1024);
+    g_FrameConstants = new FrameConstants(g_StreamBuffer, 0);
+
+    // Programs are compiled in parallel, the render loop starts drawing with the ones that are ready.
+    g_ShaderLibrary = new ShaderLibrary();
+
+    g_DeferredGPassSP = g_ShaderLibrary->load("scripts/17_ds_geometry_pass_vs.glsl", "scripts/17_ds_geometry_pass_fs.glsl");
+    g_SSAOPassSP = g_ShaderLibrary->load("scripts/19_ssao_pass_vs.glsl", "scripts/19_ssao_pass_fs.glsl", { { "MAX_KERNEL_SIZE", std::to_string(g_SSAOMaxKernelSize) } });
+    g_SSAOBlurPassSP = g_ShaderLibrary->load("scripts/19_ssao_pass_vs.glsl", "scripts/19_ssao_blur_pass_fs.glsl");
+    g_DeferredLPassSP = g_ShaderLibrary->load("scripts/17_ds_lighting_pass_vs.glsl", "scripts/17_ds_lighting_pass_fs.glsl", { { "ACTIVATE_LIGHTING", "1" } });
+    g_DeferredLPassUnlitSP = g_ShaderLibrary->load("scripts/17_ds_lighting_pass_vs.glsl", "scripts/17_ds_lighting_pass_fs.glsl", { { "ACTIVATE_LIGHTING", "0" } });
+    g_ForwardRenderingSP = g_ShaderLibrary->load("scripts/17_forward_rendering_vs.glsl", "scripts/17_forward_rendering_fs.glsl");
+
+    g_RenderQuadSP = g_ShaderLibrary->load("scripts/5_screen_quad_vs.glsl", "scripts/5_screen_quad_fs.glsl");
+
+    g_TextRendererSP = g_ShaderLibrary->load("scripts/18_text_rendering_vs.glsl", "scripts/18_text_rendering_fs.glsl");
+
+    g_ShaderLibrary->watch("scripts"); // Hot-reload programs when their sources change.
+
+    // Resolved by reflection once the program is linked.
+    g_GPassModelMatrix = g_DeferredGPassSP->getUniformHandle("uModelMatrix");
+    g_GPassInversedNormals = g_DeferredGPassSP->getUniformHandle("uInversedNormals");
+
+    g_ForwardModelMatrix = g_ForwardRenderingSP->getUniformHandle("uModelMatrix");
+    g_ForwardLightColor = g_ForwardRenderingSP->getUniformHandle("uLightColor");
+
+    for (int i = 0; i < g_MaxPointLights; i++)
+    {
+        std::string name = "uLights[" + std::to_string(i) + "]";
+
+        g_PointLightUniforms[i].m_Position = g_DeferredLPassSP->getUniformHandle((name + ".position").c_str());
+        g_PointLightUniforms[i].m_Color = g_DeferredLPassSP->getUniformHandle((name + ".color").c_str());
+        g_PointLightUniforms[i].m_Constant = g_DeferredLPassSP->getUniformHandle((name + ".constant").c_str());
+        g_PointLightUniforms[i].m_Linear = g_DeferredLPassSP->getUniformHandle((name + ".linear").c_str());
+        g_PointLightUniforms[i].m_Quadratic = g_DeferredLPassSP->getUniformHandle((name + ".quadratic").c_str());
+        g_PointLightUniforms[i].m_Radius = g_DeferredLPassSP->getUniformHandle((name + ".radius").c_str());
+    }
+
+    g_LPassProcessAllLightSources = g_DeferredLPassSP->getUniformHandle("uProcessAllLightSources");
+    g_LPassViewPos = g_DeferredLPassSP->getUniformHandle("uViewPos");
 
-    g_RenderQuadSP = new ShaderProgram("scripts/5_screen_quad_vs.glsl", "scripts/5_screen_quad_fs.glsl");
+    // Sampler units survive reloads, so they're only set once.
+    g_DeferredGPassSP->setSamplerUnit("uDiffuseMap", 5);
+    g_DeferredGPassSP->setSamplerUnit("uSpecularMap", 6);
 
-    g_TextRendererSP = new ShaderProgram("scripts/18_text_rendering_vs.glsl", "scripts/18_text_rendering_fs.glsl");
+    g_SSAOPassSP->setSamplerUnit("gPosition", 0);
+    g_SSAOPassSP->setSamplerUnit("gNormal", 1);
+    g_SSAOPassSP->setSamplerUnit("uTexNoise", 7);
+
+    g_SSAOBlurPassSP->setSamplerUnit("uSSAORaw", 3);
+
+    for (ShaderProgram* lightingPassSP : { g_DeferredLPassSP, g_DeferredLPassUnlitSP })
+    {
+        lightingPassSP->setSamplerUnit("gPosition", 0);
+        lightingPassSP->setSamplerUnit("gNormal", 1);
+        lightingPassSP->setSamplerUnit("gAlbedoAndSpecular", 2);
+        lightingPassSP->setSamplerUnit("uSSAO", 4);
+    }
+
+    g_RenderQuadSP->setSamplerUnit("uScreenTexture", 4);
+
+    g_RenderQueue = new RenderQueue();
 
     g_QuadVAO = new VertexArray();
     g_QuadVBO = new VertexBuffer(quadVertices, sizeof(quadVertices));
@@ -222,21 +382,82 @@ void setup()
     g_CubeVAO->unbind(); // Unbind VAO before another buffer.
     g_CubeVBO->unbind();
 
+    // The G-pass draws the container and the room (its normals inversed, it's seen from inside),
+    // the forward pass draws the light on top of the lit scene.
+    g_Registry = new EntityRegistry();
+
+    Material containerMaterial;
+    containerMaterial.m_Program = g_DeferredGPassSP;
+    containerMaterial.m_ModelMatrixHandle = g_GPassModelMatrix;
+    containerMaterial.m_Pass = 0;
+    containerMaterial.m_Setup = [](ShaderProgram* shaderProgram) { shaderProgram->setUniform1i(g_GPassInversedNormals, 0); };
+
+    Material roomMaterial = containerMaterial;
+    roomMaterial.m_Setup = [](ShaderProgram* shaderProgram) { shaderProgram->setUniform1i(g_GPassInversedNormals, 1); };
+
+    Material lightMaterial;
+    lightMaterial.m_Program = g_ForwardRenderingSP;
+    lightMaterial.m_ModelMatrixHandle = g_ForwardModelMatrix;
+    lightMaterial.m_Pass = 1;
+    lightMaterial.m_Setup = [](ShaderProgram* shaderProgram)
+    {
+        if (const LightSource* light = g_Registry->getLights().find(g_LightEntity))
+        {
+            shaderProgram->setUniform3f(g_ForwardLightColor, light->m_Color);
+        }
+    };
+
+    MeshRef cubeMesh = { g_CubeVAO->getID(), GL_TRIANGLES, 0, 36, false };
+    Bounds cubeBounds = { { glm::vec3(-1.0f), glm::vec3(1.0f) } };
+
+    auto createCube = [&](unsigned int node, unsigned int material)
+    {
+        Entity entity = g_Registry->create();
+
+        g_Registry->getTransforms().add(entity, { glm::mat4(1.0f), node });
+        g_Registry->getMeshes().add(entity, cubeMesh);
+        g_Registry->getMaterialRefs().add(entity, { material });
+        g_Registry->getBounds().add(entity, cubeBounds);
+
+        return entity;
+    };
+
+    createCube(g_ContainerNode, g_Registry->addMaterial(containerMaterial));
+    createCube(g_RoomNode, g_Registry->addMaterial(roomMaterial));
+
+    g_LightEntity = createCube(g_LightNode, g_Registry->addMaterial(lightMaterial));
+
+    g_Registry->getLights().add(g_LightEntity, { glm::vec3(0.25f, 0.25f, 0.75f), 1.0f, 0.09f, 0.032f });
+
     std::vector<ColorBufferConfig> gBufferConfigs = { { GL_RGBA16F, GL_NEAREST, GL_CLAMP_TO_EDGE }, { GL_RGBA16F, GL_NEAREST, GL_CLAMP_TO_EDGE }, { GL_RGBA, GL_NEAREST, GL_CLAMP_TO_EDGE } };
 
     g_GBufferFB = new FrameBuffer(g_WindowWidth, g_WindowHeight, gBufferConfigs);
     g_SSAOFB = new FrameBuffer(g_WindowWidth, g_WindowHeight, 1, GL_RED, GL_NEAREST, GL_CLAMP_TO_EDGE, FrameBuffer::BufferType::NONE);
     g_SSAOBlurFB = new FrameBuffer(g_WindowWidth, g_WindowHeight, 1, GL_RED, GL_NEAREST, GL_CLAMP_TO_EDGE, FrameBuffer::BufferType::NONE);
 
-    g_ContainerTex = new Texture("assets/textures/container.png", true);
-    g_ContainerSpecMap = new Texture("assets/textures/container_specular_map.png");
+    g_OcclusionCuller = new OcclusionCuller(g_WindowWidth, g_WindowHeight);
+
+    // Images are decoded in the background, the textures sample a placeholder meanwhile.
+    g_TextureManager = new TextureManager();
+
+    g_ContainerTex = new Texture(g_TextureManager, "assets/textures/container.png", true);
+    g_ContainerSpecMap = new Texture(g_TextureManager, "assets/textures/container_specular_map.png");
     g_SSAONoiseTex = new Texture(4, 4, GL_RGBA32F, GL_RGB, GL_FLOAT, glm::value_ptr(g_SSAONoise[0]));
 
-    g_TextRenderer = new TextRenderer("assets/fonts/Roboto-Regular.ttf");
+    g_TextRenderer = new TextRenderer("assets/fonts/Roboto-Regular.ttf", g_StreamBuffer);
+
+    // Same member order as the "SSAOKernel" block of the SSAO pass.
+    g_SSAOKernelLayout = new Std140Layout();
+
+    g_SSAOSamplesOffset    = g_SSAOKernelLayout->add(Std140Layout::Type::VEC3, g_SSAOMaxKernelSize);
+    g_SSAOKernelSizeOffset = g_SSAOKernelLayout->add(Std140Layout::Type::INT);
+    g_SSAORadiusOffset     = g_SSAOKernelLayout->add(Std140Layout::Type::FLOAT);
+    g_SSAOBiasOffset       = g_SSAOKernelLayout->add(Std140Layout::Type::FLOAT);
 
-    g_TextRendererSP->bind();
-    g_TextRendererSP->setUniformMatrix4fv("uProjectionMatrix", g_UIProjectionMatrix);
-    g_TextRendererSP->unbind();
+    g_SSAOKernelUBO = new UniformBuffer(g_SSAOKernelLayout->getSize());
+    g_SSAOKernelUBO->link(g_SSAOKernelBindingPoint);
+
+    g_SSAOPassSP->setUniformBlock("SSAOKernel", g_SSAOKernelBindingPoint);
 
     // Bind framebuffers and textures at the end to prevent conflicts.
 
@@ -259,70 +480,42 @@ void setup()
  * When performing transformations with matrices,
  * use the sequence of operations: translate -> rotate -> scale.
  */
-void render()
+void renderScene()
 {
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-
     // 1. Geometry pass (DS): Render scene's geometry/color data into gBuffer.
     {
         g_GBufferFB->bind();
-        g_DeferredGPassSP->bind();
-        g_CubeVAO->bind();
-
-        g_DeferredGPassSP->setUniformMatrix4fv("uViewMatrix", g_MainCamera->getViewMatrix());
-        g_DeferredGPassSP->setUniformMatrix4fv("uProjectionMatrix", g_ProjectionMatrix);
-        g_DeferredGPassSP->setUniform1i("uDiffuseMap", 5);
-        g_DeferredGPassSP->setUniform1i("uSpecularMap", 6);
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glm::mat4 modelMatrix = glm::mat4(1.0f);
+        glm::mat4 viewProjectionMatrix = g_ProjectionMatrix * g_MainCamera->getViewMatrix();
 
-        // 1.1. Draw the container.
-        modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, -6.5f, 0.0f));
+        // Draws every entity of the pass front to back, both cubes share the program and the vertex array.
+        g_Registry->submit(*g_RenderQueue, viewProjectionMatrix, 0, g_OcclusionCuller);
+        g_RenderQueue->flush();
 
-        g_DeferredGPassSP->setUniform1i("uInversedNormals", 0);
-        g_DeferredGPassSP->setUniformMatrix4fv("uModelMatrix", modelMatrix);
-
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        // 1.2. Draw the room.
-        modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::scale(modelMatrix, glm::vec3(7.5f, 7.5f, 7.5f));
-
-        g_DeferredGPassSP->setUniform1i("uInversedNormals", 1);
-        g_DeferredGPassSP->setUniformMatrix4fv("uModelMatrix", modelMatrix);
-
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        g_CubeVAO->unbind();
-        g_DeferredGPassSP->unbind();
-        g_GBufferFB->unbind();
+        // Read back asynchronously, it's used to cull the next frames.
+        g_OcclusionCuller->readDepth(g_GBufferFB->getID(), viewProjectionMatrix);
     }
 
     // 2. SSAO (DS): Generate the occlusion map.
     {
+        if (g_SSAOKernelChanged)
+        {
+            updateSSAOKernel();
+        }
+        else if (g_SSAOParametersChanged)
+        {
+            updateSSAOParameters();
+        }
+
+        // Every pass binds what it needs, nothing is reset in between.
         g_SSAOFB->bind();
         g_SSAOPassSP->bind();
         g_QuadVAO->bind();
 
-        g_SSAOPassSP->setUniformMatrix4fv("uProjectionMatrix", g_ProjectionMatrix);
-        g_SSAOPassSP->setUniform1i("gPosition", 0);
-        g_SSAOPassSP->setUniform1i("gNormal", 1);
-        g_SSAOPassSP->setUniform1i("uTexNoise", 7);
-
-        for (unsigned int i = 0; i < 64; i++)
-        {
-            g_SSAOPassSP->setUniform3f(("uSamples[" + std::to_string(i) + "]").c_str(), g_SSAOKernel[i]);
-        }
-
         glClear(GL_COLOR_BUFFER_BIT);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-        g_QuadVAO->unbind();
-        g_SSAOPassSP->unbind();
-        g_SSAOFB->unbind();
     }
 
     // 3. SSAO Blur (DS): Blur the SSAO texture to remove noise.
@@ -331,14 +524,10 @@ void render()
         g_SSAOBlurPassSP->bind();
         g_QuadVAO->bind();
 
-        g_SSAOBlurPassSP->setUniform1i("uSSAORaw", 3);
-
         glClear(GL_COLOR_BUFFER_BIT);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-        g_QuadVAO->unbind();
-        g_SSAOBlurPassSP->unbind();
-        g_SSAOBlurFB->unbind();
+        g_SSAOBlurFB->unbind(); // The next passes draw to the default framebuffer.
     }
 
     // DEBUG.
@@ -347,90 +536,119 @@ void render()
         g_RenderQuadSP->bind();
         g_QuadVAO->bind();
 
-        g_RenderQuadSP->setUniform1i("uScreenTexture", 4);
-
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-        g_QuadVAO->unbind();
-        g_RenderQuadSP->unbind();
-
         return;
     }
 
     // 4. Lighting pass (DS): Calculate lighting by iterating over a screen filled quad pixel-by-pixel using the gbuffer's content.
     {
-        g_DeferredLPassSP->bind();
-        g_QuadVAO->bind();
+        // Toggling the lights switches between two permutations instead of branching per pixel.
+        ShaderProgram* lightingPassSP = g_ActivateLighting == 1 ? g_DeferredLPassSP : g_DeferredLPassUnlitSP;
 
-        g_DeferredLPassSP->setUniform1i("gPosition", 0);
-        g_DeferredLPassSP->setUniform1i("gNormal", 1);
-        g_DeferredLPassSP->setUniform1i("gAlbedoAndSpecular", 2);
-        g_DeferredLPassSP->setUniform1i("uSSAO", 4);
+        lightingPassSP->bind();
+        g_QuadVAO->bind();
 
         // Setup light informations.
+        if (g_ActivateLighting == 1)
         {
-            float constant  = 1.0f;
-            float linear    = 0.09f;
-            float quadratic = 0.032f;
-            float maximum   = std::fmaxf(std::fmaxf(g_LightColor.r, g_LightColor.g), g_LightColor.b);
-            float radius    = (-linear + std::sqrtf(linear * linear - 4 * quadratic * (constant - (256.0 / 5.0) * maximum))) / (2 * quadratic);
-
-            glm::vec3 lightPosViewSpace = glm::vec3(g_MainCamera->getViewMatrix() * glm::vec4(g_LightPosition, 1.0f));
-
-            g_DeferredLPassSP->setUniform3f("uLights[0].position", lightPosViewSpace);
-            g_DeferredLPassSP->setUniform3f("uLights[0].color", g_LightColor);
-            g_DeferredLPassSP->setUniform1f("uLights[0].constant", constant);
-            g_DeferredLPassSP->setUniform1f("uLights[0].linear", linear);
-            g_DeferredLPassSP->setUniform1f("uLights[0].quadratic", quadratic);
-            g_DeferredLPassSP->setUniform1f("uLights[0].radius", radius);
+            // Every light source entity, positioned by its transform.
+            const std::vector<Entity>& lightEntities = g_Registry->getLights().getEntities();
+            const std::vector<LightSource>& lights = g_Registry->getLights().getComponents();
+
+            // Lights without a transform have no position, they're skipped.
+            for (size_t i = 0, slot = 0; i < lights.size() && slot < (size_t)g_MaxPointLights; i++)
+            {
+                const Transform* transform = g_Registry->getTransforms().find(lightEntities[i]);
+
+                if (!transform)
+                {
+                    continue;
+                }
+
+                const LightSource& light = lights[i];
+                const PointLightUniforms& uniforms = g_PointLightUniforms[slot++];
+
+                float maximum   = std::fmaxf(std::fmaxf(light.m_Color.r, light.m_Color.g), light.m_Color.b);
+                float radius    = (-light.m_Linear + std::sqrtf(light.m_Linear * light.m_Linear - 4 * light.m_Quadratic * (light.m_Constant - (256.0 / 5.0) * maximum))) / (2 * light.m_Quadratic);
+
+                glm::vec3 lightPosViewSpace = glm::vec3(g_MainCamera->getViewMatrix() * transform->m_ModelMatrix[3]);
+
+                g_DeferredLPassSP->setUniform3f(uniforms.m_Position, lightPosViewSpace);
+                g_DeferredLPassSP->setUniform3f(uniforms.m_Color, light.m_Color);
+                g_DeferredLPassSP->setUniform1f(uniforms.m_Constant, light.m_Constant);
+                g_DeferredLPassSP->setUniform1f(uniforms.m_Linear, light.m_Linear);
+                g_DeferredLPassSP->setUniform1f(uniforms.m_Quadratic, light.m_Quadratic);
+                g_DeferredLPassSP->setUniform1f(uniforms.m_Radius, radius);
+            }
+
+            g_DeferredLPassSP->setUniform1i(g_LPassProcessAllLightSources, 1);
+            g_DeferredLPassSP->setUniform3f(g_LPassViewPos, g_MainCamera->getPosition());
         }
 
-        g_DeferredLPassSP->setUniform1i("uActivateLighting", g_ActivateLighting);
-        g_DeferredLPassSP->setUniform1i("uProcessAllLightSources", 1);
-        g_DeferredLPassSP->setUniform3f("uViewPos", g_MainCamera->getPosition());
-
-        glEnable(GL_FRAMEBUFFER_SRGB); // Enable gamma correction.
+        GLStateCache::setEnabled(GL_FRAMEBUFFER_SRGB, true); // Enable gamma correction.
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glDisable(GL_FRAMEBUFFER_SRGB);
-
-        g_QuadVAO->unbind();
-        g_DeferredLPassSP->unbind();
+        GLStateCache::setEnabled(GL_FRAMEBUFFER_SRGB, false);
     }
 
     // 5. Copy content of geometry's depth buffer to default framebuffer's depth buffer.
     {
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, g_GBufferFB->getID());
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        GLStateCache::bindFramebuffer(GL_READ_FRAMEBUFFER, g_GBufferFB->getID());
+        GLStateCache::bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
         glBlitFramebuffer(0, 0, g_WindowWidth, g_WindowHeight, 0, 0, g_WindowWidth, g_WindowHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
     // 4. Forward rendering: Render the light on top of the scene.
     {
-        g_ForwardRenderingSP->bind();
-        g_CubeVAO->bind();
+        g_Registry->submit(*g_RenderQueue, g_ProjectionMatrix * g_MainCamera->getViewMatrix(), 1);
+        g_RenderQueue->flush();
+    }
+}
+
+void render()
+{
+    // Per-frame data is written into the region of the stream buffer the GPU is done with.
+    g_StreamBuffer->beginFrame();
 
-        glm::mat4 modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::translate(modelMatrix, g_LightPosition);
-        modelMatrix = glm::scale(modelMatrix, glm::vec3(0.125f));
+    GLStateCache::beginFrame();
+    Frustum::beginFrame();
+    g_Registry->beginFrame();
 
-        g_ForwardRenderingSP->setUniformMatrix4fv("uViewMatrix", g_MainCamera->getViewMatrix());
-        g_ForwardRenderingSP->setUniformMatrix4fv("uProjectionMatrix", g_ProjectionMatrix);
-        g_ForwardRenderingSP->setUniformMatrix4fv("uModelMatrix", modelMatrix);
-        g_ForwardRenderingSP->setUniform3f("uLightColor", g_LightColor);
+    // Decoded images are uploaded within a per-frame budget.
+    g_TextureManager->update();
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // The scene is only drawn once all of its programs finished compiling.
+    if (g_ShaderLibrary->isReady())
+    {
+        g_FrameConstants->update(g_MainCamera->getViewMatrix(), g_ProjectionMatrix, g_MainCamera->getPosition(), glm::vec2(g_WindowWidth, g_WindowHeight), g_LastFrame);
+        g_OcclusionCuller->update(g_ProjectionMatrix * g_MainCamera->getViewMatrix());
+        g_SceneGraph->update();
+        g_Registry->updateTransforms(*g_SceneGraph);
+        g_Registry->updateBounds();
 
-        g_CubeVAO->unbind();
-        g_ForwardRenderingSP->unbind();
+        renderScene();
+    }
+    else
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
     // Text rendering.
+    if (g_TextRendererSP->isReady())
     {
-        g_TextRenderer->write(*g_TextRendererSP, "(C) LearnOpenGL.com", 32.0f, 32.0f, 0.35f, glm::vec3(0.3, 0.75f, 0.8f));
+        // Uniforms don't survive a relink, so they are set every frame (see hot-reload).
+        g_TextRendererSP->bind();
+        g_TextRendererSP->setUniformMatrix4fv("uProjectionMatrix", g_UIProjectionMatrix);
+
+        // Every queued text is drawn at once by "flush".
+        g_TextRenderer->queue("(C) LearnOpenGL.com", 32.0f, 32.0f, 0.35f, glm::vec3(0.3, 0.75f, 0.8f));
+        g_TextRenderer->flush(*g_TextRendererSP);
     }
 
     // Draw ImGui interface/frame.
@@ -444,6 +662,37 @@ void render()
             ImGui::Begin("General");
             ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
             ImGui::Text("Lights: %s", g_ActivateLighting == 1 ? "ENABLED" : "DISABLED");
+            ImGui::Text("GL calls: %u issued, %u skipped", GLStateCache::getStatistics().m_IssuedCalls, GLStateCache::getStatistics().m_SkippedCalls);
+            ImGui::Text("Culling: %u visible, %u culled", Frustum::getStatistics().m_Visible, Frustum::getStatistics().m_Culled);
+            ImGui::Text("Occlusion: %u tested, %u occluded", g_OcclusionCuller->getStatistics().m_Tested, g_OcclusionCuller->getStatistics().m_Occluded);
+            ImGui::Text("Scene graph: %u/%zu nodes updated", g_SceneGraph->getNumberOfUpdatedNodes(), g_SceneGraph->getNumberOfNodes());
+            ImGui::Text("Entities: %zu, %zu draws", g_Registry->getNumberOfEntities(), g_Registry->getNumberOfPackets());
+
+            if (g_Registry->isAlive(g_PickedEntity))
+            {
+                ImGui::Text("Picked: entity %u", getEntityIndex(g_PickedEntity));
+            }
+            else
+            {
+                ImGui::Text("Picked: none");
+            }
+
+            g_SSAOKernelChanged |= ImGui::SliderInt("SSAO Kernel Size", &g_SSAOKernelSize, 1, g_SSAOMaxKernelSize);
+            g_SSAOParametersChanged |= ImGui::SliderFloat("SSAO Radius", &g_SSAORadius, 0.05f, 2.0f);
+            g_SSAOParametersChanged |= ImGui::SliderFloat("SSAO Bias", &g_SSAOBias, 0.0f, 0.1f, "%.3f");
+            ImGui::End();
+        }
+
+        {
+            ImGui::Begin("GPU Resources");
+
+            for (int i = 0; i < (int)ResourceTracker::Category::NUMBER_OF_CATEGORIES; i++)
+            {
+                ResourceTracker::Category category = (ResourceTracker::Category)i;
+
+                ImGui::Text("%s: %zu (%.1f KB)", ResourceTracker::getName(category), ResourceTracker::getCount(category), ResourceTracker::getBytes(category) / 1024.0f);
+            }
+
             ImGui::End();
         }
 
@@ -451,12 +700,62 @@ void render()
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     }
+
+    g_StreamBuffer->endFrame();
 }
 
-int main()
+void cleanup()
+{
+    // Textures release their streamed images through the manager, it goes after them.
+    delete g_TextRenderer;
+    delete g_SSAONoiseTex;
+    delete g_ContainerSpecMap;
+    delete g_ContainerTex;
+    delete g_TextureManager;
+
+    if (TextureCache::getNumberOfTextures())
+    {
+        std::cout << "[ERROR] TEXTURE CACHE: " << TextureCache::getNumberOfTextures() << " texture(s) still referenced at exit." << std::endl;
+    }
+
+    delete g_OcclusionCuller;
+    delete g_SSAOBlurFB;
+    delete g_SSAOFB;
+    delete g_GBufferFB;
+
+    delete g_Registry;
+    delete g_CubeVBO;
+    delete g_CubeVAO;
+    delete g_QuadVBO;
+    delete g_QuadVAO;
+    delete g_RenderQueue;
+
+    delete g_SSAOKernelUBO;
+    delete g_SSAOKernelLayout;
+
+    delete g_ShaderLibrary; // Deletes every shader program.
+    delete g_FrameConstants;
+    delete g_StreamBuffer;
+    delete g_SceneGraph;
+    delete g_MainCamera;
+}
+
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    /* Convert textures offline, no window nor context needed */
+    if (argc > 1 && std::string(argv[1]) == "--compress-textures")
+    {
+        return TextureCompressor::run(argc - 2, argv + 2);
+    }
+
+    /* Compare the BVH against brute force, no window nor context needed either */
+    if (argc > 1 && std::string(argv[1]) == "--benchmark-bvh")
+    {
+        return BoundingVolumeHierarchy::benchmark(argc - 2, argv + 2);
+    }
+
     /* Initialize GLFW */
     if (!glfwInit())
     {
@@ -515,9 +814,9 @@ int main()
     glViewport(0, 0, g_WindowWidth, g_WindowHeight);
 
     /* Enable OpenGL features */
-    glEnable(GL_DEPTH_TEST);       // Enable depth test.
-    // glEnable(GL_BLEND);         // Enable blending.
-    glEnable(GL_MULTISAMPLE);      // Enable multisampling.
+    GLStateCache::setEnabled(GL_DEPTH_TEST, true);    // Enable depth test.
+    // GLStateCache::setEnabled(GL_BLEND, true);      // Enable blending.
+    GLStateCache::setEnabled(GL_MULTISAMPLE, true);   // Enable multisampling.
     // (...)                       // Enable gamma correction only for the last vertex shader.
     // (...)                       // Enable face culling only for rendering closed shapes.
 
@@ -527,21 +826,22 @@ int main()
     // after each fragment shader run to all subsequent framebuffers, including the default framebuffer.
 
     /* Configure depth buffer */
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE); // Allows to enable/disable writing to the depth buffer.
+    GLStateCache::setDepthFunc(GL_LESS);
+    GLStateCache::setDepthMask(true); // Allows to enable/disable writing to the depth buffer.
 
     /* Configure blending */
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Allows us to set the source and destination factor values of the blend equation.
+    GLStateCache::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Allows us to set the source and destination factor values of the blend equation.
                                                        // We can also do more stuff with "glBlendColor", "glBlendFuncSeparate" and "glBlendEquation" functions. 
 
     /* Configure face culling */
     glFrontFace(GL_CCW); // Consider counter-clockwise faces as front faces.
-    glCullFace(GL_BACK);
+    GLStateCache::setCullFace(GL_BACK);
 
     /* Define window callbacks */
     glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
     glfwSetKeyCallback(window, keyboardCallback);
     glfwSetCursorPosCallback(window, cursorPositionCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
     glfwSetScrollCallback(window, scrollCallback);
 
     setup();
@@ -556,6 +856,9 @@ int main()
         g_DeltaTime = currentFrame - g_LastFrame;
         g_LastFrame = currentFrame;
 
+        /* Finish pending shader compilations */
+        g_ShaderLibrary->update();
+
         /* Render here */
         render();
 
@@ -570,6 +873,10 @@ int main()
     }
 
     /* Cleanup */
+    cleanup();
+
+    ResourceTracker::report(); // Everything was deleted, any count left is a leak.
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -665,6 +972,37 @@ void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos)
     g_MainCamera->setDirection(xOffset, yOffset);
 }
 
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    ImGui_ImplGlfw_MouseButtonCallback(window, button, action, mods); // Replaced by this one, ImGui's still needs the clicks.
+
+    if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS)
+    {
+        return;
+    }
+
+    // A free cursor picks what's under it, a captured one what's in the middle of the screen.
+    glm::vec2 cursorPosition = glm::vec2(g_WindowWidth, g_WindowHeight) * 0.5f;
+
+    if (g_CursorMode == GLFW_CURSOR_NORMAL)
+    {
+        if (ImGui::GetIO().WantCaptureMouse)
+        {
+            return;
+        }
+
+        double xpos, ypos;
+        glfwGetCursorPos(window, &xpos, &ypos);
+
+        cursorPosition = glm::vec2(xpos, ypos);
+    }
+
+    glm::vec3 rayDirection = g_MainCamera->getRayDirection(cursorPosition, glm::vec2(g_WindowWidth, g_WindowHeight), g_ProjectionMatrix);
+    float distance;
+
+    g_PickedEntity = g_Registry->pick(g_MainCamera->getPosition(), rayDirection, distance);
+}
+
 void scrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
     g_FieldOfView = g_FieldOfView - (float)yoffset;
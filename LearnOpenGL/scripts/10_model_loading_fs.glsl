@@ -1,46 +1,10 @@
 #version 330 core
 
-#define N_POINT_LIGHTS 4
 #define N_MAT_COLOR_MAPS 1
 
-struct DirectionalLight
-{
-    vec3 direction;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight
-{
-    vec3 position;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-	
-    float constant;
-    float linear;
-    float quadratic;
-};
-
-struct SpotLight
-{
-    vec3 position;
-    vec3 direction;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    float cutOff;
-    float outerCutOff;
-};
+#include "include/lighting.glsl"
+#include "include/light_casters.glsl"
+#include "include/normal_mapping.glsl"
 
 struct Material
 {
@@ -67,12 +31,12 @@ out vec4 FragColor;
 
 vec3 calcDirectionalLight(DirectionalLight lightSource)
 {
-    vec3 fragNormal = normalize(ioTBN * (texture(uMaterial.normalMaps[0], ioTexCoords).rgb * 2.0 - 1.0)); // Obtain the normal vector in range [0,1] and transform it to range [-1,1].
+    vec3 fragNormal = normalize(ioTBN * sampleNormalMap(uMaterial.normalMaps[0], ioTexCoords)); // Tangent-space normal, transformed to world space.
     vec3 lightDir   = normalize(-lightSource.direction);
     vec3 viewDir    = normalize(uViewPos - ioFragPos);
     vec3 halfwayDir = normalize(lightDir + viewDir);
 
-    float diffuseStr  = max(dot(fragNormal, lightDir), 0.0);
+    float diffuseStr  = calcDiffuseStrength(fragNormal, lightDir);
     float specularStr = 0.5 * pow(max(dot(viewDir, halfwayDir), 0.0), uMaterial.shininess);
 
     // Calculating "Phong Lighting" components.
@@ -86,15 +50,15 @@ vec3 calcDirectionalLight(DirectionalLight lightSource)
 
 vec3 calcPointLight(PointLight lightSource)
 {
-    vec3 fragNormal = normalize(ioTBN * (texture(uMaterial.normalMaps[0], ioTexCoords).rgb * 2.0 - 1.0)); // Obtain the normal vector in range [0,1] and transform it to range [-1,1].
+    vec3 fragNormal = normalize(ioTBN * sampleNormalMap(uMaterial.normalMaps[0], ioTexCoords)); // Tangent-space normal, transformed to world space.
     vec3 lightDir   = normalize(lightSource.position - ioFragPos);
     vec3 viewDir    = normalize(uViewPos - ioFragPos);
     vec3 halfwayDir = normalize(lightDir + viewDir);
 
-    float diffuseStr  = max(dot(fragNormal, lightDir), 0.0);
+    float diffuseStr  = calcDiffuseStrength(fragNormal, lightDir);
     float specularStr = 0.5 * pow(max(dot(viewDir, halfwayDir), 0.0), uMaterial.shininess);
     float distance    = length(lightSource.position - ioFragPos);
-    float attenuation = 1.0 / (lightSource.constant + lightSource.linear * distance + lightSource.quadratic * (distance * distance));
+    float attenuation = calcAttenuation(lightSource.constant, lightSource.linear, lightSource.quadratic, distance);
 
     // Calculating "Phong Lighting" components.
 
@@ -111,19 +75,17 @@ vec3 calcPointLight(PointLight lightSource)
 
 vec3 calcSpotLight(SpotLight lightSource)
 {
-    vec3 fragNormal = normalize(ioTBN * (texture(uMaterial.normalMaps[0], ioTexCoords).rgb * 2.0 - 1.0)); // Obtain the normal vector in range [0,1] and transform it to range [-1,1].
+    vec3 fragNormal = normalize(ioTBN * sampleNormalMap(uMaterial.normalMaps[0], ioTexCoords)); // Tangent-space normal, transformed to world space.
     vec3 lightDir   = normalize(lightSource.position - ioFragPos);
     vec3 viewDir    = normalize(uViewPos - ioFragPos);
     vec3 halfwayDir = normalize(lightDir + viewDir);
 
-    float theta     = dot(lightDir, normalize(-lightSource.direction));
-    float epsilon   = lightSource.cutOff - lightSource.outerCutOff;
-    float intensity = clamp((theta - lightSource.outerCutOff) / epsilon, 0.0, 1.0);
+    float intensity = calcSpotLightIntensity(lightSource, lightDir);
     
-    float diffuseStr  = max(dot(fragNormal, lightDir), 0.0);
+    float diffuseStr  = calcDiffuseStrength(fragNormal, lightDir);
     float specularStr = 0.5 * pow(max(dot(viewDir, halfwayDir), 0.0), uMaterial.shininess);
     float distance    = length(lightSource.position - ioFragPos);
-    float attenuation = 1.0 / (lightSource.constant + lightSource.linear * distance + lightSource.quadratic * (distance * distance));
+    float attenuation = calcAttenuation(lightSource.constant, lightSource.linear, lightSource.quadratic, distance);
 
     // Calculating "Phong Lighting" components.
 
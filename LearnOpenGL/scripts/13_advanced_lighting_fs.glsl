@@ -1,5 +1,7 @@
 #version 330 core
 
+#include "include/pcf.glsl"
+
 struct Light
 {
     vec3 ambient;
@@ -41,9 +43,6 @@ float calcShadowingFactor(vec3 lightDir)
     // Get closest depth value from light's perspective.
     // float closestDepth = texture(uShadowMap, projCoords.xy).r;
 
-    // Get depth of current fragment from light's perspective.
-    float currentDepth = projCoords.z;
-
     // Check whether current fragment position is in shadow.
     if (projCoords.z > 1.0)
     {
@@ -58,24 +57,9 @@ float calcShadowingFactor(vec3 lightDir)
         // a matter of slowly incrementing the bias until all acne is removed.
         //
         float bias = max(0.05 * (1.0 - dot(fs_in.Normal, lightDir)), 0.005);
-        float factor = 0.0;
-
-        vec2 texelSize = 1.0 / textureSize(uShadowMap, 0);
 
         // Applying percentage-closer filtering.
-        for (int x = -1; x <= 1; ++x)
-        {
-            for (int y = -1; y <= 1; ++y)
-            {
-                float pcfDepth = texture(uShadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-
-                factor += (currentDepth - bias > pcfDepth ? 1.0 : 0.0);        
-            }    
-        }
-
-        factor /= 9.0;
-
-        return factor;
+        return calcShadowingFactorPCF(uShadowMap, projCoords, bias);
     }
 }
 
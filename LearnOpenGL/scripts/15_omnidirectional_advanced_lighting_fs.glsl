@@ -1,5 +1,7 @@
 #version 330 core
 
+#include "include/pcf.glsl"
+
 struct Light
 {
     vec3 ambient;
@@ -32,15 +34,6 @@ out vec4 FragColor;
 
 float calcShadowingFactor(vec3 lightDir)
 {
-    vec3 sampleOffsetDirections[20] = vec3[]
-    (
-        vec3(1, 1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1, 1,  1),
-        vec3(1, 1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
-        vec3(1, 1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1, 1,  0),
-        vec3(1, 0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1, 0, -1),
-        vec3(0, 1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0, 1, -1)
-    );
-
     // Get vector between fragment position and light position.
     vec3 fragToLight = fs_in.FragPos - uLight.position; 
 
@@ -50,33 +43,13 @@ float calcShadowingFactor(vec3 lightDir)
     // It is currently in linear range between [0,1], so re-transform back to original value.
     // closestDepth *= uFarPlane;
 
-    // Now get current linear depth as the length between the fragment and light position.
-    float currentDepth = length(fragToLight);
-
     // Finally, test for shadows.
-    int samples = 20;
-
     float bias = 0.15;
-    float factor = 0.0;
     float viewDistance = length(uViewPos - fs_in.FragPos);
     float diskRadius = (1.0 + (viewDistance / uFarPlane)) / 25.0;
 
     // Applying percentage-closer filtering.
-    for (int i = 0; i < samples; ++i)
-    {
-        float closestDepth = texture(uShadowMap, fragToLight + sampleOffsetDirections[i] * diskRadius).r;
-
-        closestDepth *= uFarPlane; // Undo mapping [0;1].
-
-        if (currentDepth - bias > closestDepth)
-        {
-            factor += 1.0;
-        }
-    }
-
-    factor /= float(samples);
-
-    return factor;
+    return calcShadowingFactorOmniPCF(uShadowMap, fragToLight, uFarPlane, diskRadius, bias);
 }
 
 void main()
@@ -1,5 +1,7 @@
 #version 330 core
 
+#include "include/normal_mapping.glsl"
+
 struct Light // Represents a point light type.
 {
     vec3 ambientComp;
@@ -90,7 +92,7 @@ void main()
     vec3 halfwayDir = normalize(lightDir + viewDir);
 
     vec2 texCoords = calcParallaxOcclusionMapping(viewDir); // Displaced texture coordinates.
-    vec3 fragNormal = normalize(texture(uMaterial.normalMap, texCoords).rgb * 2.0 - 1.0);
+    vec3 fragNormal = normalize(sampleNormalMap(uMaterial.normalMap, texCoords));
 
     if (!uEnableNPMapping) // When normal and parallax mapping are disabled.
     {
@@ -1,12 +1,12 @@
 #version 330 core
 
+#include "include/frame_constants.glsl"
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
 uniform mat4 uModelMatrix;
-uniform mat4 uViewMatrix;
-uniform mat4 uProjectionMatrix;
 
 uniform bool uInversedNormals = false;
 
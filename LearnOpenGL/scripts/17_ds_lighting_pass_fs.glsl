@@ -1,6 +1,16 @@
 #version 330 core
 
+// Both can be injected as defines by the application (one program per permutation).
+
+#ifndef N_POINT_LIGHTS
 #define N_POINT_LIGHTS 1
+#endif
+
+#ifndef ACTIVATE_LIGHTING
+#define ACTIVATE_LIGHTING 1
+#endif
+
+#include "include/lighting.glsl"
 
 struct Light // Represents a point light type.
 {
@@ -22,7 +32,6 @@ uniform sampler2D gAlbedoAndSpecular;
 uniform sampler2D uSSAO;
 
 uniform Light uLights[N_POINT_LIGHTS];
-uniform bool uActivateLighting = true;
 uniform bool uProcessAllLightSources = true;
 uniform vec3 uViewPos;
 
@@ -32,11 +41,10 @@ vec3 calcPointLight(Light lightSource, float lightDis, vec3 fragPos, vec3 fragNo
 {
     vec3 lightDir = normalize(lightSource.position - fragPos);
     vec3 viewDir = normalize(uViewPos - fragPos);
-    vec3 halfwayDir = normalize(lightDir + viewDir);
 
-    float diffuseStr = max(dot(fragNormal, lightDir), 0.0);
-    float specularStr = pow(max(dot(fragNormal, halfwayDir), 0.0), 8.0);
-    float attenuation = 1.0 / (lightSource.constant + lightSource.linear * lightDis + lightSource.quadratic * (lightDis * lightDis));
+    float diffuseStr = calcDiffuseStrength(fragNormal, lightDir);
+    float specularStr = calcBlinnPhongSpecularStrength(fragNormal, lightDir, viewDir, 8.0);
+    float attenuation = calcAttenuation(lightSource.constant, lightSource.linear, lightSource.quadratic, lightDis);
 
     // Calculating the rest of the "Blinn-Phong Lighting" components.
 
@@ -60,18 +68,17 @@ void main()
 
     pixelColor += ambientComp;
 
-    if (uActivateLighting)
+#if ACTIVATE_LIGHTING
+    for (int i = 0; i < N_POINT_LIGHTS; i++)
     {
-        for (int i = 0; i < N_POINT_LIGHTS; i++)
-        {
-            float distance = length(uLights[i].position - fragPos);
+        float distance = length(uLights[i].position - fragPos);
 
-            if(uProcessAllLightSources || distance < uLights[i].radius)
-            {
-                pixelColor += calcPointLight(uLights[i], distance, fragPos, fragNormal, fragDiffuseAndSpecular.rgb, fragDiffuseAndSpecular.a);
-            }
+        if(uProcessAllLightSources || distance < uLights[i].radius)
+        {
+            pixelColor += calcPointLight(uLights[i], distance, fragPos, fragNormal, fragDiffuseAndSpecular.rgb, fragDiffuseAndSpecular.a);
         }
     }
+#endif
 
     FragColor = vec4(pixelColor, 1.0);
 }
\ No newline at end of file
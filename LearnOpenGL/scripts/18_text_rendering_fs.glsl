@@ -1,13 +1,18 @@
 #version 330 core
 
 in vec2 ioTexCoords;
+in vec3 ioColor;
 
 out vec4 Color;
 
 uniform sampler2D uText;
-uniform vec3 uTextColor;
 
 void main()
 {
-    Color = vec4(uTextColor, 1.0) * vec4(1.0, 1.0, 1.0, texture(uText, ioTexCoords).r);
+    // Glyphs are signed distance fields, their outline lies at 0.5. Smoothing over the
+    // screen-space derivative keeps the edges sharp (and anti-aliased) at any scale.
+    float distance = texture(uText, ioTexCoords).r;
+    float smoothing = fwidth(distance);
+
+    Color = vec4(ioColor, smoothstep(0.5 - smoothing, 0.5 + smoothing, distance));
 }
\ No newline at end of file
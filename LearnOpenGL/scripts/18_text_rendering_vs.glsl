@@ -1,14 +1,17 @@
 #version 330 core
 
 layout (location = 0) in vec4 aVertex; // <vec2 aPos, vec2 aTexCoords>
+layout (location = 1) in vec3 aColor;
 
 uniform mat4 uProjectionMatrix;
 
 out vec2 ioTexCoords;
+out vec3 ioColor;
 
 void main()
 {
     gl_Position = uProjectionMatrix * vec4(aVertex.xy, 0.0, 1.0);
 
     ioTexCoords = aVertex.zw;
+    ioColor = aColor;
 }
\ No newline at end of file
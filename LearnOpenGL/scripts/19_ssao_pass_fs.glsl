@@ -1,26 +1,34 @@
 #version 330 core
 
+#include "include/frame_constants.glsl"
+
+// The capacity of the kernel is injected as a define, the size actually used is a setting.
+#ifndef MAX_KERNEL_SIZE
+#define MAX_KERNEL_SIZE 64
+#endif
+
 in vec2 ioTexCoords;
 
 uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D uTexNoise;
 
-uniform vec3 uSamples[64];
-uniform mat4 uProjectionMatrix;
+// Uploaded once, and again only when the settings change.
+layout (std140) uniform SSAOKernel
+{
+    vec3  uSamples[MAX_KERNEL_SIZE];
+    int   uKernelSize;
+    float uRadius;
+    float uBias;
+};
 
 out float FragColor;
 
-// Global parameters (you'd probably want to use them as uniforms to more easily tweak the effect).
-const int kernelSize = 64;
-float radius = 0.5;
-float bias = 0.025;
-
-// It's the tile noise texture over screen based on screen dimensions divided by noise size.
-const vec2 noiseScale = vec2(1280.0 / 4.0, 720.0 / 4.0);
-
 void main()
 {
+    // It's the tile noise texture over screen based on screen dimensions divided by noise size.
+    vec2 noiseScale = uViewport.xy / 4.0;
+
     // Get inputs for SSAO algorithm.
     vec3 fragPos = texture(gPosition, ioTexCoords).xyz;
     vec3 fragNormal = normalize(texture(gNormal, ioTexCoords).xyz);
@@ -34,11 +42,11 @@ void main()
     // Iterate over the sample kernel and calculate occlusion factor.
     float occlusion = 0.0;
 
-    for(int i = 0; i < kernelSize; ++i)
+    for(int i = 0; i < uKernelSize; ++i)
     {
         // Get sample position.
         vec3 samplePos = TBN * uSamples[i]; // From tangent to view-space.
-        samplePos = fragPos + samplePos * radius;
+        samplePos = fragPos + samplePos * uRadius;
         
         // Project sample position (to sample texture) (to get position on screen/texture).
         vec4 offset = vec4(samplePos, 1.0);
@@ -50,12 +58,12 @@ void main()
         float sampleDepth = texture(gPosition, offset.xy).z; // Get depth value of kernel sample.
         
         // Calculate the range check & accumulate.
-        float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sampleDepth));
+        float rangeCheck = smoothstep(0.0, 1.0, uRadius / abs(fragPos.z - sampleDepth));
 
-        occlusion += (sampleDepth >= samplePos.z + bias ? 1.0 : 0.0) * rangeCheck;
+        occlusion += (sampleDepth >= samplePos.z + uBias ? 1.0 : 0.0) * rangeCheck;
     }
 
-    occlusion = 1.0 - (occlusion / kernelSize);
+    occlusion = 1.0 - (occlusion / float(uKernelSize));
     
     FragColor = occlusion;
 }
\ No newline at end of file
@@ -1,45 +1,7 @@
 #version 330 core
 
-#define N_POINT_LIGHTS 4
-
-struct DirectionalLight
-{
-    vec3 direction;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight
-{
-    vec3 position;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-	
-    float constant;
-    float linear;
-    float quadratic;
-};
-
-struct SpotLight
-{
-    vec3 position;
-    vec3 direction;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    float cutOff;
-    float outerCutOff;
-};
+#include "include/lighting.glsl"
+#include "include/light_casters.glsl"
 
 struct Material
 {
@@ -67,7 +29,7 @@ vec3 calcDirectionalLight(DirectionalLight lightSource)
     vec3 viewDir    = normalize(uViewPos - oiFragPos);
     vec3 reflectDir = reflect(-lightDir, fragNormal);
 
-    float diffuseStr  = max(dot(fragNormal, lightDir), 0.0);
+    float diffuseStr  = calcDiffuseStrength(fragNormal, lightDir);
     float specularStr = 0.5 * pow(max(dot(viewDir, reflectDir), 0.0), uMaterial.shininess);
 
     // Calculating "Phong Lighting" components.
@@ -86,10 +48,10 @@ vec3 calcPointLight(PointLight lightSource)
     vec3 viewDir    = normalize(uViewPos - oiFragPos);
     vec3 reflectDir = reflect(-lightDir, fragNormal);
 
-    float diffuseStr  = max(dot(fragNormal, lightDir), 0.0);
+    float diffuseStr  = calcDiffuseStrength(fragNormal, lightDir);
     float specularStr = 0.5 * pow(max(dot(viewDir, reflectDir), 0.0), uMaterial.shininess);
     float distance    = length(lightSource.position - oiFragPos);
-    float attenuation = 1.0 / (lightSource.constant + lightSource.linear * distance + lightSource.quadratic * (distance * distance));
+    float attenuation = calcAttenuation(lightSource.constant, lightSource.linear, lightSource.quadratic, distance);
 
     // Calculating "Phong Lighting" components.
 
@@ -111,14 +73,12 @@ vec3 calcSpotLight(SpotLight lightSource)
     vec3 viewDir    = normalize(uViewPos - oiFragPos);
     vec3 reflectDir = reflect(-lightDir, fragNormal);
 
-    float theta     = dot(lightDir, normalize(-lightSource.direction));
-    float epsilon   = lightSource.cutOff - lightSource.outerCutOff;
-    float intensity = clamp((theta - lightSource.outerCutOff) / epsilon, 0.0, 1.0);
-    
-    float diffuseStr  = max(dot(fragNormal, lightDir), 0.0);
+    float intensity = calcSpotLightIntensity(lightSource, lightDir);
+
+    float diffuseStr  = calcDiffuseStrength(fragNormal, lightDir);
     float specularStr = 0.5 * pow(max(dot(viewDir, reflectDir), 0.0), uMaterial.shininess);
     float distance    = length(lightSource.position - oiFragPos);
-    float attenuation = 1.0 / (lightSource.constant + lightSource.linear * distance + lightSource.quadratic * (distance * distance));
+    float attenuation = calcAttenuation(lightSource.constant, lightSource.linear, lightSource.quadratic, distance);
 
     // Calculating "Phong Lighting" components.
 
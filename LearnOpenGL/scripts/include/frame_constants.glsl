@@ -0,0 +1,12 @@
+// Per-frame constants, written once per frame by the application (see "FrameConstants").
+
+layout (std140) uniform FrameConstants
+{
+    mat4  uViewMatrix;
+    mat4  uProjectionMatrix;
+    mat4  uInverseViewMatrix;
+    mat4  uInverseProjectionMatrix;
+    vec4  uViewport; // Size in xy, inverse size in zw.
+    vec3  uCameraPosition;
+    float uTime;
+};
@@ -0,0 +1,54 @@
+// Light caster types (directional, point and spot lights).
+//
+// The number of point lights can be injected as a define (N_POINT_LIGHTS).
+
+#ifndef N_POINT_LIGHTS
+#define N_POINT_LIGHTS 4
+#endif
+
+struct DirectionalLight
+{
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight
+{
+    vec3 position;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+	
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct SpotLight
+{
+    vec3 position;
+    vec3 direction;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    float cutOff;
+    float outerCutOff;
+};
+
+float calcSpotLightIntensity(SpotLight lightSource, vec3 lightDir)
+{
+    float theta   = dot(lightDir, normalize(-lightSource.direction));
+    float epsilon = lightSource.cutOff - lightSource.outerCutOff;
+
+    return clamp((theta - lightSource.outerCutOff) / epsilon, 0.0, 1.0);
+}
@@ -0,0 +1,18 @@
+// Lighting terms shared by the "Blinn-Phong Lighting" shaders.
+
+float calcAttenuation(float constant, float linear, float quadratic, float distance)
+{
+    return 1.0 / (constant + linear * distance + quadratic * (distance * distance));
+}
+
+float calcDiffuseStrength(vec3 fragNormal, vec3 lightDir)
+{
+    return max(dot(fragNormal, lightDir), 0.0);
+}
+
+float calcBlinnPhongSpecularStrength(vec3 fragNormal, vec3 lightDir, vec3 viewDir, float shininess)
+{
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+
+    return pow(max(dot(fragNormal, halfwayDir), 0.0), shininess);
+}
@@ -0,0 +1,9 @@
+// Tangent-space normal of a normal map. Only the red and green channels are read, the third
+// component is rebuilt, so two-channel (BC5) normal maps work the same as RGB ones.
+
+vec3 sampleNormalMap(sampler2D normalMap, vec2 texCoords)
+{
+    vec2 normal = texture(normalMap, texCoords).rg * 2.0 - 1.0;
+
+    return vec3(normal, sqrt(max(1.0 - dot(normal, normal), 0.0)));
+}
@@ -0,0 +1,63 @@
+// Percentage-closer filtering of shadow maps.
+//
+// The filter sizes can be injected as defines: PCF_RADIUS for 2D shadow maps (in texels)
+// and PCF_SAMPLES for omnidirectional ones (up to 20).
+
+#ifndef PCF_RADIUS
+#define PCF_RADIUS 1
+#endif
+
+#ifndef PCF_SAMPLES
+#define PCF_SAMPLES 20
+#endif
+
+const vec3 c_PCFSampleOffsetDirections[20] = vec3[]
+(
+    vec3(1, 1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1, 1,  1),
+    vec3(1, 1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
+    vec3(1, 1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1, 1,  0),
+    vec3(1, 0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1, 0, -1),
+    vec3(0, 1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0, 1, -1)
+);
+
+// "projCoords" are the fragment's light space coordinates, already in range [0,1].
+float calcShadowingFactorPCF(sampler2D shadowMap, vec3 projCoords, float bias)
+{
+    float currentDepth = projCoords.z;
+    float factor = 0.0;
+
+    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+
+    for (int x = -PCF_RADIUS; x <= PCF_RADIUS; ++x)
+    {
+        for (int y = -PCF_RADIUS; y <= PCF_RADIUS; ++y)
+        {
+            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+
+            factor += (currentDepth - bias > pcfDepth ? 1.0 : 0.0);        
+        }    
+    }
+
+    return factor / float((2 * PCF_RADIUS + 1) * (2 * PCF_RADIUS + 1));
+}
+
+// "fragToLight" goes from the light to the fragment, the cube map stores depths in range [0,1].
+float calcShadowingFactorOmniPCF(samplerCube shadowMap, vec3 fragToLight, float farPlane, float diskRadius, float bias)
+{
+    float currentDepth = length(fragToLight);
+    float factor = 0.0;
+
+    for (int i = 0; i < PCF_SAMPLES; ++i)
+    {
+        float closestDepth = texture(shadowMap, fragToLight + c_PCFSampleOffsetDirections[i] * diskRadius).r;
+
+        closestDepth *= farPlane; // Undo mapping [0;1].
+
+        if (currentDepth - bias > closestDepth)
+        {
+            factor += 1.0;
+        }
+    }
+
+    return factor / float(PCF_SAMPLES);
+}
@@ -0,0 +1,570 @@
+#include "BoundingVolumeHierarchy.h"
+
+const float BoundingVolumeHierarchy::s_TraversalCost = 1.0f;
+const float BoundingVolumeHierarchy::s_RebuildThreshold = 1.5f;
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+	: m_Nodes(), m_Items(), m_Boxes(), m_Parents(), m_ItemLeaves(), m_DirtyLeaves(), m_WeightedArea(0.0), m_BuildCost(0.0f)
+{
+}
+
+void BoundingVolumeHierarchy::build(const std::vector<BoundingBox>& boxes)
+{
+	std::vector<glm::vec3> centroids(boxes.size());
+
+	m_Boxes = boxes;
+	m_Nodes.clear();
+	m_Parents.clear();
+	m_DirtyLeaves.clear();
+	m_Items.resize(boxes.size());
+	m_ItemLeaves.resize(boxes.size());
+	m_WeightedArea = 0.0;
+
+	for (unsigned int i = 0; i < boxes.size(); i++)
+	{
+		m_Items[i] = i;
+		centroids[i] = (boxes[i].m_Min + boxes[i].m_Max) * 0.5f;
+	}
+
+	// At most "2n - 1" nodes, reserved so that building never reallocates.
+	m_Nodes.reserve(boxes.empty() ? 0 : 2 * boxes.size() - 1);
+	m_Parents.reserve(m_Nodes.capacity());
+
+	if (!boxes.empty())
+	{
+		buildNode(0, (unsigned int)boxes.size(), 0, centroids);
+	}
+
+	m_BuildCost = getCost();
+}
+
+void BoundingVolumeHierarchy::update(const unsigned int item, const BoundingBox& box)
+{
+	m_Boxes[item] = box;
+	m_DirtyLeaves.push_back(m_ItemLeaves[item]);
+}
+
+bool BoundingVolumeHierarchy::refit()
+{
+	for (unsigned int leaf : m_DirtyLeaves)
+	{
+		BoundingBox box;
+		const Node& node = m_Nodes[leaf];
+
+		for (unsigned int i = node.m_Offset; i < node.m_Offset + node.m_NumberOfItems; i++)
+		{
+			box.extend(m_Boxes[m_Items[i]]);
+		}
+
+		// Ancestors are refitted until one of them doesn't change.
+		for (unsigned int current = leaf; ; current = m_Parents[current])
+		{
+			if (current != leaf)
+			{
+				const Node& left = m_Nodes[current + 1];
+				const Node& right = m_Nodes[m_Nodes[current].m_Offset];
+
+				box = BoundingBox{ glm::min(left.m_Min, right.m_Min), glm::max(left.m_Max, right.m_Max) };
+			}
+
+			if (box.m_Min == m_Nodes[current].m_Min && box.m_Max == m_Nodes[current].m_Max)
+			{
+				break;
+			}
+
+			setNodeBox(current, box);
+
+			if (current == 0)
+			{
+				break;
+			}
+		}
+	}
+
+	m_DirtyLeaves.clear();
+
+	// Refitted boxes overlap more and more, past some point a new tree is cheaper.
+	if (getCost() > m_BuildCost * s_RebuildThreshold)
+	{
+		std::vector<BoundingBox> boxes;
+
+		boxes.swap(m_Boxes);
+		build(boxes);
+
+		return true;
+	}
+
+	return false;
+}
+
+void BoundingVolumeHierarchy::cull(const Frustum& frustum, std::vector<unsigned int>& items) const
+{
+	// Nodes fully inside the frustum add their whole subtree without any further test.
+	std::vector<std::pair<unsigned int, bool>> stack;
+
+	if (!m_Nodes.empty())
+	{
+		stack.push_back({ 0, false });
+	}
+
+	while (!stack.empty())
+	{
+		unsigned int index = stack.back().first;
+		bool inside = stack.back().second;
+		const Node& node = m_Nodes[index];
+
+		stack.pop_back();
+
+		if (!inside)
+		{
+			Frustum::Containment containment = frustum.getContainment({ node.m_Min, node.m_Max });
+
+			if (containment == Frustum::Containment::OUTSIDE)
+			{
+				continue;
+			}
+
+			inside = containment == Frustum::Containment::INSIDE;
+		}
+
+		if (node.m_NumberOfItems == 0)
+		{
+			stack.push_back({ node.m_Offset, inside });
+			stack.push_back({ index + 1, inside });
+
+			continue;
+		}
+
+		for (unsigned int i = node.m_Offset; i < node.m_Offset + node.m_NumberOfItems; i++)
+		{
+			if (inside || frustum.getContainment(m_Boxes[m_Items[i]]) != Frustum::Containment::OUTSIDE)
+			{
+				items.push_back(m_Items[i]);
+			}
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::query(const BoundingBox& box, std::vector<unsigned int>& items) const
+{
+	auto overlaps = [&box](const glm::vec3& min, const glm::vec3& max)
+	{
+		return glm::all(glm::lessThanEqual(min, box.m_Max)) && glm::all(glm::greaterThanEqual(max, box.m_Min));
+	};
+
+	std::vector<unsigned int> stack;
+
+	if (!m_Nodes.empty())
+	{
+		stack.push_back(0);
+	}
+
+	while (!stack.empty())
+	{
+		const Node& node = m_Nodes[stack.back()];
+		unsigned int index = stack.back();
+
+		stack.pop_back();
+
+		if (!overlaps(node.m_Min, node.m_Max))
+		{
+			continue;
+		}
+
+		if (node.m_NumberOfItems == 0)
+		{
+			stack.push_back(node.m_Offset);
+			stack.push_back(index + 1);
+
+			continue;
+		}
+
+		for (unsigned int i = node.m_Offset; i < node.m_Offset + node.m_NumberOfItems; i++)
+		{
+			const BoundingBox& itemBox = m_Boxes[m_Items[i]];
+
+			if (overlaps(itemBox.m_Min, itemBox.m_Max))
+			{
+				items.push_back(m_Items[i]);
+			}
+		}
+	}
+}
+
+bool BoundingVolumeHierarchy::raycast(const glm::vec3& origin, const glm::vec3& direction, unsigned int& item, float& distance, const bool skipContaining) const
+{
+	// Divisions by zero give infinities, which the slab test handles.
+	glm::vec3 inverseDirection = 1.0f / direction;
+	float nearest = FLT_MAX;
+	bool hit = false;
+
+	std::vector<unsigned int> stack;
+
+	if (!m_Nodes.empty())
+	{
+		stack.push_back(0);
+	}
+
+	while (!stack.empty())
+	{
+		unsigned int index = stack.back();
+		const Node& node = m_Nodes[index];
+		float nodeDistance;
+
+		stack.pop_back();
+
+		// Nodes further than the nearest hit so far are skipped.
+		if (!intersect(node.m_Min, node.m_Max, origin, inverseDirection, nearest, nodeDistance))
+		{
+			continue;
+		}
+
+		if (node.m_NumberOfItems == 0)
+		{
+			// The nearer child is visited first, it's pushed last.
+			float leftDistance, rightDistance;
+			const Node& left = m_Nodes[index + 1];
+			const Node& right = m_Nodes[node.m_Offset];
+
+			bool leftHit = intersect(left.m_Min, left.m_Max, origin, inverseDirection, nearest, leftDistance);
+			bool rightHit = intersect(right.m_Min, right.m_Max, origin, inverseDirection, nearest, rightDistance);
+
+			if (leftHit && rightHit && leftDistance < rightDistance)
+			{
+				stack.push_back(node.m_Offset);
+				stack.push_back(index + 1);
+			}
+			else if (leftHit && rightHit)
+			{
+				stack.push_back(index + 1);
+				stack.push_back(node.m_Offset);
+			}
+			else if (leftHit || rightHit)
+			{
+				stack.push_back(leftHit ? index + 1 : node.m_Offset);
+			}
+
+			continue;
+		}
+
+		for (unsigned int i = node.m_Offset; i < node.m_Offset + node.m_NumberOfItems; i++)
+		{
+			const BoundingBox& box = m_Boxes[m_Items[i]];
+			float itemDistance;
+
+			if (skipContaining && glm::all(glm::greaterThanEqual(origin, box.m_Min)) && glm::all(glm::lessThanEqual(origin, box.m_Max)))
+			{
+				continue;
+			}
+
+			if (intersect(box.m_Min, box.m_Max, origin, inverseDirection, nearest, itemDistance))
+			{
+				nearest = itemDistance;
+				item = m_Items[i];
+				hit = true;
+			}
+		}
+	}
+
+	distance = nearest;
+
+	return hit;
+}
+
+size_t BoundingVolumeHierarchy::getNumberOfItems() const
+{
+	return m_Boxes.size();
+}
+
+const std::vector<BoundingVolumeHierarchy::Node>& BoundingVolumeHierarchy::getNodes() const
+{
+	return m_Nodes;
+}
+
+float BoundingVolumeHierarchy::getCost() const
+{
+	if (m_Nodes.empty())
+	{
+		return 0.0f;
+	}
+
+	float rootArea = getArea(m_Nodes[0].m_Min, m_Nodes[0].m_Max);
+
+	// A flat root (e.g. a single point) is hit by every query anyway.
+	return rootArea > 0.0f ? (float)(m_WeightedArea / rootArea) : (float)m_Boxes.size();
+}
+
+int BoundingVolumeHierarchy::benchmark(int argc, char** argv)
+{
+	using Clock = std::chrono::steady_clock;
+
+	auto getMilliseconds = [](const Clock::time_point& start, const Clock::time_point& end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	};
+
+	std::vector<size_t> sizes;
+
+	for (int i = 0; i < argc; i++)
+	{
+		char* end;
+		unsigned long size = std::strtoul(argv[i], &end, 10);
+
+		// "strtoul" accepts a sign, and wraps negative numbers around.
+		if (!std::isdigit((unsigned char)argv[i][0]) || *end != '\0' || size == 0 || size == ULONG_MAX)
+		{
+			std::cout << "[ERROR] BVH BENCHMARK: Invalid number of instances \"" << argv[i] << "\"." << std::endl;
+			std::cout << "Usage: LearnOpenGL --benchmark-bvh [number of instances]..." << std::endl;
+
+			return 1;
+		}
+
+		sizes.push_back(size);
+	}
+
+	if (sizes.empty())
+	{
+		sizes = { 10000, 100000, 1000000 };
+	}
+
+	for (size_t numberOfInstances : sizes)
+	{
+		// Same density whatever the count, the camera sees a similar number of instances.
+		std::mt19937 random(42);
+		float halfSize = 5.0f * std::cbrt((float)numberOfInstances);
+		std::uniform_real_distribution<float> position(-halfSize, halfSize), size(0.25f, 1.0f), offset(-0.5f, 0.5f);
+
+		std::vector<BoundingBox> boxes(numberOfInstances);
+		BoundingBoxSet boxSet;
+
+		for (BoundingBox& box : boxes)
+		{
+			glm::vec3 center(position(random), position(random), position(random));
+			glm::vec3 extent(size(random), size(random), size(random));
+
+			box = { center - extent, center + extent };
+			boxSet.add(box);
+		}
+
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		Frustum frustum(projection * view);
+		glm::vec3 rayDirection = glm::normalize(glm::vec3(0.3f, 0.2f, -1.0f));
+
+		// Build.
+		BoundingVolumeHierarchy hierarchy;
+		Clock::time_point start = Clock::now();
+
+		hierarchy.build(boxes);
+
+		Clock::time_point built = Clock::now();
+
+		// Frustum culling.
+		std::vector<unsigned char> visibility(numberOfInstances);
+		size_t bruteForceVisible = frustum.cull(boxSet, visibility.data());
+
+		Clock::time_point bruteForceCulled = Clock::now();
+
+		std::vector<unsigned int> visible;
+		hierarchy.cull(frustum, visible);
+
+		Clock::time_point hierarchyCulled = Clock::now();
+
+		// Ray picking.
+		float bruteForceDistance = FLT_MAX;
+		glm::vec3 inverseDirection = 1.0f / rayDirection;
+
+		for (const BoundingBox& box : boxes)
+		{
+			float distance;
+
+			if (intersect(box.m_Min, box.m_Max, glm::vec3(0.0f), inverseDirection, bruteForceDistance, distance))
+			{
+				bruteForceDistance = distance;
+			}
+		}
+
+		Clock::time_point bruteForcePicked = Clock::now();
+
+		unsigned int pickedItem = 0;
+		float pickedDistance = FLT_MAX;
+		hierarchy.raycast(glm::vec3(0.0f), rayDirection, pickedItem, pickedDistance);
+
+		Clock::time_point hierarchyPicked = Clock::now();
+
+		// Refit after moving 1% of the instances.
+		float buildCost = hierarchy.getCost();
+
+		for (size_t i = 0; i < numberOfInstances; i += 100)
+		{
+			glm::vec3 move(offset(random), offset(random), offset(random));
+
+			hierarchy.update((unsigned int)i, { boxes[i].m_Min + move, boxes[i].m_Max + move });
+		}
+
+		Clock::time_point refitStart = Clock::now();
+		bool rebuilt = hierarchy.refit();
+		Clock::time_point refitted = Clock::now();
+
+		std::cout << "[INFO] BVH BENCHMARK: " << numberOfInstances << " instances, " << hierarchy.getNodes().size() << " nodes, SAH cost " << buildCost << "." << std::endl;
+		std::cout << "  build " << getMilliseconds(start, built) << " ms, refit of 1% " << getMilliseconds(refitStart, refitted) << " ms" << (rebuilt ? " (rebuilt)" : "") << std::endl;
+		std::cout << "  frustum: brute force " << getMilliseconds(built, bruteForceCulled) << " ms, BVH " << getMilliseconds(bruteForceCulled, hierarchyCulled) << " ms (" << bruteForceVisible << " / " << visible.size() << " visible)" << std::endl;
+		std::cout << "  ray:     brute force " << getMilliseconds(hierarchyCulled, bruteForcePicked) << " ms, BVH " << getMilliseconds(bruteForcePicked, hierarchyPicked) << " ms (" << bruteForceDistance << " / " << pickedDistance << ")" << std::endl;
+
+		if (bruteForceVisible != visible.size() || bruteForceDistance != pickedDistance)
+		{
+			std::cout << "[ERROR] BVH BENCHMARK: Results differ from brute force." << std::endl;
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+unsigned int BoundingVolumeHierarchy::buildNode(const unsigned int begin, const unsigned int end, const unsigned int parent, const std::vector<glm::vec3>& centroids)
+{
+	unsigned int index = (unsigned int)m_Nodes.size();
+	unsigned int numberOfItems = end - begin;
+
+	BoundingBox box, centroidBox;
+
+	for (unsigned int i = begin; i < end; i++)
+	{
+		box.extend(m_Boxes[m_Items[i]]);
+		centroidBox.extend(centroids[m_Items[i]]);
+	}
+
+	m_Nodes.push_back({});
+	m_Parents.push_back(parent);
+	setNodeBox(index, box);
+
+	// Split along the axis the centroids spread the most on.
+	glm::vec3 spread = centroidBox.m_Max - centroidBox.m_Min;
+	int axis = spread.x > spread.y && spread.x > spread.z ? 0 : (spread.y > spread.z ? 1 : 2);
+
+	unsigned int middle = begin;
+
+	if (numberOfItems > 1 && spread[axis] > 0.0f)
+	{
+		BoundingBox bins[s_NumberOfBins];
+		unsigned int counts[s_NumberOfBins] = {};
+		float scale = s_NumberOfBins / spread[axis];
+
+		auto getBin = [&](const unsigned int item)
+		{
+			return std::min((int)((centroids[item][axis] - centroidBox.m_Min[axis]) * scale), s_NumberOfBins - 1);
+		};
+
+		for (unsigned int i = begin; i < end; i++)
+		{
+			int bin = getBin(m_Items[i]);
+
+			bins[bin].extend(m_Boxes[m_Items[i]]);
+			counts[bin]++;
+		}
+
+		// Sweeps from both ends, the split after bin "i" costs its left and right areas times their counts.
+		float leftCosts[s_NumberOfBins - 1];
+		BoundingBox left, right;
+		unsigned int leftCount = 0, rightCount = 0;
+
+		for (int i = 0; i < s_NumberOfBins - 1; i++)
+		{
+			left.extend(bins[i]);
+			leftCount += counts[i];
+			leftCosts[i] = leftCount ? getArea(left.m_Min, left.m_Max) * leftCount : 0.0f;
+		}
+
+		float bestCost = FLT_MAX;
+		int bestSplit = -1;
+
+		for (int i = s_NumberOfBins - 1; i > 0; i--)
+		{
+			right.extend(bins[i]);
+			rightCount += counts[i];
+
+			float cost = leftCosts[i - 1] + (rightCount ? getArea(right.m_Min, right.m_Max) * rightCount : 0.0f);
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplit = i - 1;
+			}
+		}
+
+		float area = getArea(box.m_Min, box.m_Max);
+		float splitCost = s_TraversalCost + (area > 0.0f ? bestCost / area : (float)numberOfItems);
+
+		// Small nodes stay leaves unless splitting them is expected to be cheaper.
+		if (numberOfItems > (unsigned int)s_MaxItemsPerLeaf || splitCost < (float)numberOfItems)
+		{
+			middle = (unsigned int)(std::partition(m_Items.begin() + begin, m_Items.begin() + end, [&](const unsigned int item) { return getBin(item) <= bestSplit; }) - m_Items.begin());
+		}
+	}
+	else if (numberOfItems > (unsigned int)s_MaxItemsPerLeaf)
+	{
+		// Same centroids, any halving is as good as another.
+		middle = begin + numberOfItems / 2;
+	}
+
+	if (middle == begin || middle == end)
+	{
+		if (numberOfItems <= (unsigned int)s_MaxItemsPerLeaf)
+		{
+			m_Nodes[index].m_Offset = begin;
+			m_Nodes[index].m_NumberOfItems = numberOfItems;
+			m_WeightedArea += getArea(box.m_Min, box.m_Max) * (numberOfItems - s_TraversalCost);
+
+			for (unsigned int i = begin; i < end; i++)
+			{
+				m_ItemLeaves[m_Items[i]] = index;
+			}
+
+			return index;
+		}
+
+		middle = begin + numberOfItems / 2;
+	}
+
+	buildNode(begin, middle, index, centroids);
+	m_Nodes[index].m_Offset = buildNode(middle, end, index, centroids);
+
+	return index;
+}
+
+void BoundingVolumeHierarchy::setNodeBox(const unsigned int node, const BoundingBox& box)
+{
+	Node& current = m_Nodes[node];
+	float weight = current.m_NumberOfItems ? (float)current.m_NumberOfItems : s_TraversalCost;
+
+	// New nodes start with a null area.
+	m_WeightedArea -= getArea(current.m_Min, current.m_Max) * weight;
+
+	current.m_Min = box.m_Min;
+	current.m_Max = box.m_Max;
+
+	m_WeightedArea += getArea(current.m_Min, current.m_Max) * weight;
+}
+
+float BoundingVolumeHierarchy::getArea(const glm::vec3& min, const glm::vec3& max)
+{
+	glm::vec3 size = max - min;
+
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+bool BoundingVolumeHierarchy::intersect(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection, const float maxDistance, float& distance)
+{
+	// Slab test, the ray enters the box after entering all three slabs.
+	glm::vec3 t0 = (min - origin) * inverseDirection;
+	glm::vec3 t1 = (max - origin) * inverseDirection;
+	glm::vec3 tMin = glm::min(t0, t1), tMax = glm::max(t0, t1);
+
+	float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+	float exit = std::min(std::min(tMax.x, tMax.y), tMax.z);
+
+	distance = enter;
+
+	return enter <= exit && enter < maxDistance;
+}
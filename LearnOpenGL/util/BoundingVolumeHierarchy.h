@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cmath>
+#include <cctype>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Frustum.h"
+
+// Bounding volume hierarchy over axis-aligned boxes (e.g. the world bounds of scene instances
+// or of meshes), so that frustum culling, ray picking and region queries (e.g. the shadow
+// casters inside a light's frustum) don't test every item.
+//
+// It's built top-down with a binned surface area heuristic (SAH), then flattened into a single
+// node array in depth-first order: the left child of an interior node follows it and only the
+// right one is stored, and the items of every subtree are contiguous. Moved items only refit the
+// boxes above them, the tree is rebuilt once its SAH cost grew past "s_RebuildThreshold" times
+// its cost right after the last build. Item boxes must not be empty.
+//
+// A benchmark against brute force (SIMD frustum tests and a linear ray scan) runs with:
+//
+//	LearnOpenGL --benchmark-bvh [number of instances]...
+class BoundingVolumeHierarchy
+{
+public:
+	// 32 bytes, two per cache line.
+	struct Node
+	{
+		glm::vec3 m_Min;
+		unsigned int m_Offset; // First item of a leaf, right child of an interior node.
+		glm::vec3 m_Max;
+		unsigned int m_NumberOfItems; // Zero for interior nodes.
+	};
+
+	BoundingVolumeHierarchy();
+
+	void build(const std::vector<BoundingBox>& boxes);
+
+	// Moves an item, the tree is only refitted by "refit".
+	void update(const unsigned int item, const BoundingBox& box);
+
+	// Returns whether the tree had to be rebuilt instead.
+	bool refit();
+
+	void cull(const Frustum& frustum, std::vector<unsigned int>& items) const;
+	void query(const BoundingBox& box, std::vector<unsigned int>& items) const;
+
+	// Nearest item whose box the ray hits, the distance is in units of "direction". Items whose
+	// box contains the origin are skipped when "skipContaining" is set (e.g. a room around the camera).
+	bool raycast(const glm::vec3& origin, const glm::vec3& direction, unsigned int& item, float& distance, const bool skipContaining = false) const;
+
+	size_t getNumberOfItems() const;
+	const std::vector<Node>& getNodes() const;
+	float getCost() const; // Expected cost of a query, relative to a single box test.
+
+	static int benchmark(int argc, char** argv);
+
+	static const int s_NumberOfBins = 16;
+	static const int s_MaxItemsPerLeaf = 8;
+
+private:
+	static const float s_TraversalCost; // Of a node, relative to an item test.
+	static const float s_RebuildThreshold;
+
+	std::vector<Node> m_Nodes;
+	std::vector<unsigned int> m_Items; // Ordered by leaf.
+	std::vector<BoundingBox> m_Boxes; // Per item.
+
+	std::vector<unsigned int> m_Parents; // Per node, the root is its own parent.
+	std::vector<unsigned int> m_ItemLeaves; // Per item.
+	std::vector<unsigned int> m_DirtyLeaves;
+
+	double m_WeightedArea; // Sum of the node areas weighted by their cost, kept up to date by refits.
+	float m_BuildCost;
+
+	unsigned int buildNode(const unsigned int begin, const unsigned int end, const unsigned int parent, const std::vector<glm::vec3>& centroids);
+	void setNodeBox(const unsigned int node, const BoundingBox& box);
+
+	static float getArea(const glm::vec3& min, const glm::vec3& max); // Half of the surface area.
+	static bool intersect(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection, const float maxDistance, float& distance);
+};
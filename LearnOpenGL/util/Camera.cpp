@@ -25,6 +25,17 @@ const glm::vec3& Camera::getDirection()
 	return m_Direction;
 }
 
+glm::vec3 Camera::getRayDirection(const glm::vec2& cursorPosition, const glm::vec2& windowSize, const glm::mat4& projectionMatrix)
+{
+	glm::vec2 ndc(2.0f * cursorPosition.x / windowSize.x - 1.0f, 1.0f - 2.0f * cursorPosition.y / windowSize.y);
+	glm::mat4 inverse = glm::inverse(projectionMatrix * m_ViewMatrix);
+
+	glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+
+	return glm::normalize(glm::vec3(farPoint) / farPoint.w - glm::vec3(nearPoint) / nearPoint.w);
+}
+
 void Camera::setPosition(const float& speed, const Direction& movementDirection)
 {
 	switch (movementDirection)
@@ -18,6 +18,10 @@ public:
 	const glm::vec3& getPosition();
 	const glm::vec3& getDirection();
 
+	// Normalized world-space direction of the ray from the camera through a cursor position
+	// (in window coordinates, origin at the top left), e.g. for picking.
+	glm::vec3 getRayDirection(const glm::vec2& cursorPosition, const glm::vec2& windowSize, const glm::mat4& projectionMatrix);
+
 	void setPosition(const float& speed, const Direction& movementDirection);
 	void setDirection(const float& xOffset, const float& yOffset);
 
@@ -1,82 +1,52 @@
 #include "CubeMap.h"
 
 CubeMap::CubeMap(const char* filepath, const std::array<const char*, 6>& faces)
-	: m_ID()
+	: CubeMap(nullptr, filepath, faces)
 {
-	glGenTextures(1, &m_ID);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
+}
 
-	stbi_set_flip_vertically_on_load(false);
+CubeMap::CubeMap(TextureManager* textureManager, const char* filepath, const std::array<const char*, 6>& faces)
+	: m_ID(), m_Unit(-1)
+{
+	std::array<std::string, 6> filepaths;
 
 	for (unsigned int i = 0; i < faces.size(); i++)
 	{
-		std::string buff = "";
-
-		buff.append(filepath);
-		buff.append("/");
-		buff.append(faces[i]);
-
-		int format = GL_RED; // Default format.
-		int width, height, colorChannels;
-		unsigned char* data = stbi_load(buff.c_str(), &width, &height, &colorChannels, 0);
-
-		switch (colorChannels)
-		{
-		case 3:
-			format = GL_RGB;
-			break;
-
-		case 4:
-			format = GL_RGBA;
-			break;
-
-		default:
-			std::cout << "[ERROR] CUBEMAP: Texture format not supported." << std::endl;
-
-			break;
-		}
+		filepaths[i] = std::string(filepath) + "/" + faces[i];
+	}
 
-		// Texture Target					Orientation
-		// 
-		// GL_TEXTURE_CUBE_MAP_POSITIVE_X	Right
-		// GL_TEXTURE_CUBE_MAP_NEGATIVE_X	Left
-		// GL_TEXTURE_CUBE_MAP_POSITIVE_Y	Top
-		// GL_TEXTURE_CUBE_MAP_NEGATIVE_Y	Bottom
-		// GL_TEXTURE_CUBE_MAP_POSITIVE_Z	Back
-		// GL_TEXTURE_CUBE_MAP_NEGATIVE_Z	Front
-		//
-		if (data)
-		{
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		}
-		else
-		{
-			std::cout << "[ERROR] CUBEMAP: Failed to load texture in \"" << filepath << "\"." << std::endl;
-		}
+	// Without a manager, the faces are loaded right away.
+	m_ID = TextureCache::loadCubeMap(filepaths, textureManager);
+}
 
-		stbi_image_free(data);
+CubeMap::~CubeMap()
+{
+	if (m_ID != 0)
+	{
+		TextureCache::release(m_ID);
 	}
+}
 
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+CubeMap::CubeMap(CubeMap&& other) noexcept : m_ID(other.m_ID), m_Unit(other.m_Unit)
+{
+	other.m_ID = 0;
 }
 
-CubeMap::~CubeMap()
+CubeMap& CubeMap::operator=(CubeMap&& other) noexcept
 {
-	glDeleteTextures(1, &m_ID);
+	std::swap(m_ID, other.m_ID);
+	std::swap(m_Unit, other.m_Unit);
+
+	return *this;
 }
 
 void CubeMap::bind(int unit)
 {
 	if (unit >= 0 && unit <= 15)
 	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
+		GLStateCache::bindTexture(unit, GL_TEXTURE_CUBE_MAP, m_ID);
+
+		m_Unit = unit;
 	}
 	else
 	{
@@ -86,5 +56,10 @@ void CubeMap::bind(int unit)
 
 void CubeMap::unbind()
 {
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	if (m_Unit >= 0)
+	{
+		GLStateCache::bindTexture(m_Unit, GL_TEXTURE_CUBE_MAP, 0);
+
+		m_Unit = -1;
+	}
 }
\ No newline at end of file
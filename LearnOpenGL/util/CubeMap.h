@@ -1,25 +1,31 @@
 #pragma once
 
 #include <array>
+#include <string>
 #include <iostream>
 
 #include <glad/glad.h>
 
-#if !defined _STB_IMAGE_INCLUDED
-#define _STB_IMAGE_INCLUDED
-
-#include <stb/stb_image.h>
-#endif // _STB_IMAGE_INCLUDED
+#include "TextureCache.h"
+#include "../core/GLStateCache.h"
 
 class CubeMap
 {
 public:
 	CubeMap(const char* filepath, const std::array<const char*, 6>& faces);
+	CubeMap(TextureManager* textureManager, const char* filepath, const std::array<const char*, 6>& faces);
 	~CubeMap();
 
+	CubeMap(CubeMap&& other) noexcept;
+	CubeMap& operator=(CubeMap&& other) noexcept;
+
+	CubeMap(const CubeMap&) = delete;
+	CubeMap& operator=(const CubeMap&) = delete;
+
 	void bind(int unit);
 	void unbind();
 
 private:
 	unsigned int m_ID;
+	int m_Unit; // Last unit it was bound to, if any.
 };
\ No newline at end of file
@@ -4,15 +4,18 @@ DepthMap::DepthMap(int width, int height, const BufferType& type)
 	: m_ID(), m_DepthBuffer(), m_DepthBufferType(type)
 {
 	glGenFramebuffers(1, &m_ID);
-	glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_ID);
 
 	glGenTextures(1, &m_DepthBuffer);
 
+	ResourceTracker::track(ResourceTracker::Category::FRAMEBUFFER, m_ID);
+	ResourceTracker::track(ResourceTracker::Category::TEXTURE, m_DepthBuffer, ResourceTracker::getTextureSize(GL_DEPTH_COMPONENT, width, height) * (type == BufferType::TEXTURE_2D ? 1 : 6));
+
 	if (type == BufferType::TEXTURE_2D)
 	{
 		float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 		
-		glBindTexture(GL_TEXTURE_2D, m_DepthBuffer);
+		GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D, m_DepthBuffer);
 	
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 	
@@ -27,7 +30,7 @@ DepthMap::DepthMap(int width, int height, const BufferType& type)
 	}
 	else
 	{
-		glBindTexture(GL_TEXTURE_CUBE_MAP, m_DepthBuffer);
+		GLStateCache::bindTextureForUpdate(GL_TEXTURE_CUBE_MAP, m_DepthBuffer);
 
 		for (unsigned int i = 0; i < 6; ++i)
 		{
@@ -51,47 +54,55 @@ DepthMap::DepthMap(int width, int height, const BufferType& type)
 	glDrawBuffer(GL_NONE);
 	glReadBuffer(GL_NONE);
 
-	if (type == BufferType::TEXTURE_2D)
-	{
-		glBindTexture(GL_TEXTURE_2D, 0);
-	}
-	else
-	{
-		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-	}
-
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 DepthMap::~DepthMap()
 {
+	ResourceTracker::untrack(ResourceTracker::Category::FRAMEBUFFER, m_ID);
+	ResourceTracker::untrack(ResourceTracker::Category::TEXTURE, m_DepthBuffer);
+
 	glDeleteFramebuffers(1, &m_ID);
 	glDeleteTextures(1, &m_DepthBuffer);
 }
 
+DepthMap::DepthMap(DepthMap&& other) noexcept
+	: m_ID(), m_DepthBuffer(), m_DepthBufferType(other.m_DepthBufferType)
+{
+	*this = std::move(other);
+}
+
+DepthMap& DepthMap::operator=(DepthMap&& other) noexcept
+{
+	// The previous buffers are deleted along with "other".
+	std::swap(m_ID, other.m_ID);
+	std::swap(m_DepthBuffer, other.m_DepthBuffer);
+	std::swap(m_DepthBufferType, other.m_DepthBufferType);
+
+	return *this;
+}
+
 void DepthMap::bind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_ID);
 }
 
 void DepthMap::unbind()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void DepthMap::bindDepthBuffer(int unit)
 {
 	if (unit >= 0 && unit <= 15)
 	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-
 		if (m_DepthBufferType == BufferType::TEXTURE_2D)
 		{
-			glBindTexture(GL_TEXTURE_2D, m_DepthBuffer);
+			GLStateCache::bindTexture(unit, GL_TEXTURE_2D, m_DepthBuffer);
 		}
 		else
 		{
-			glBindTexture(GL_TEXTURE_CUBE_MAP, m_DepthBuffer);
+			GLStateCache::bindTexture(unit, GL_TEXTURE_CUBE_MAP, m_DepthBuffer);
 		}
 	}
 	else
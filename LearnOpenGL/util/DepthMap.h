@@ -1,9 +1,13 @@
 #pragma once
 
+#include <utility>
 #include <iostream>
 
 #include <glad/glad.h>
 
+#include "../core/ResourceTracker.h"
+#include "../core/GLStateCache.h"
+
 class DepthMap
 {
 public:
@@ -12,6 +16,12 @@ public:
 	DepthMap(int width, int height, const BufferType& type = BufferType::TEXTURE_2D);
 	~DepthMap();
 
+	DepthMap(DepthMap&& other) noexcept;
+	DepthMap& operator=(DepthMap&& other) noexcept;
+
+	DepthMap(const DepthMap&) = delete;
+	DepthMap& operator=(const DepthMap&) = delete;
+
 	void bind();
 	void unbind();
 
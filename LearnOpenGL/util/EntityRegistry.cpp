@@ -0,0 +1,293 @@
+#include "EntityRegistry.h"
+
+EntityRegistry::EntityRegistry()
+	: m_Transforms(), m_Meshes(), m_MaterialRefs(), m_Bounds(), m_Lights(), m_Materials(), m_Generations(), m_FreeIndices(), m_NumberOfEntities(0),
+	  m_Hierarchy(), m_ItemEntities(), m_ItemBoxes(), m_EntityItems(), m_NextItemEntities(), m_NextItemBoxes(), m_Packets(), m_VisibleItems(), m_Visibility(),
+	  m_NumberOfPackets(0), m_LastNumberOfPackets(0)
+{
+}
+
+Entity EntityRegistry::create()
+{
+	unsigned int index;
+
+	if (!m_FreeIndices.empty())
+	{
+		index = m_FreeIndices.back();
+		m_FreeIndices.pop_back();
+	}
+	else
+	{
+		if (m_Generations.size() >= s_MaxEntities)
+		{
+			std::cout << "[ERROR] ENTITY REGISTRY: More than " << s_MaxEntities << " entities." << std::endl;
+
+			return s_NullEntity;
+		}
+
+		index = (unsigned int)m_Generations.size();
+		m_Generations.push_back(0);
+	}
+
+	m_NumberOfEntities++;
+
+	return (unsigned int)m_Generations[index] << 24 | index;
+}
+
+void EntityRegistry::destroy(const Entity entity)
+{
+	if (!isAlive(entity))
+	{
+		return;
+	}
+
+	m_Transforms.remove(entity);
+	m_Meshes.remove(entity);
+	m_MaterialRefs.remove(entity);
+	m_Bounds.remove(entity);
+	m_Lights.remove(entity);
+
+	// The index is reused with the next generation, handles to this entity become stale.
+	m_Generations[getEntityIndex(entity)]++;
+	m_FreeIndices.push_back(getEntityIndex(entity));
+
+	m_NumberOfEntities--;
+}
+
+bool EntityRegistry::isAlive(const Entity entity) const
+{
+	unsigned int index = getEntityIndex(entity);
+
+	return index < m_Generations.size() && m_Generations[index] == entity >> 24;
+}
+
+unsigned int EntityRegistry::addMaterial(Material material)
+{
+	material.m_ID = RenderQueue::getMaterialID(material.m_Textures.data(), (unsigned int)material.m_Textures.size());
+
+	m_Materials.push_back(std::move(material));
+
+	return (unsigned int)m_Materials.size() - 1;
+}
+
+Material& EntityRegistry::getMaterial(const unsigned int material)
+{
+	return m_Materials[material];
+}
+
+void EntityRegistry::updateTransforms(const SceneGraph& sceneGraph)
+{
+	for (Transform& transform : m_Transforms.getComponents())
+	{
+		if (transform.m_Node != SceneGraph::s_NoParent)
+		{
+			transform.m_ModelMatrix = sceneGraph.getWorldMatrix(transform.m_Node);
+		}
+	}
+}
+
+void EntityRegistry::updateBounds()
+{
+	const std::vector<Entity>& entities = m_Bounds.getEntities();
+	const std::vector<Bounds>& bounds = m_Bounds.getComponents();
+
+	m_NextItemEntities.clear();
+	m_NextItemBoxes.clear();
+
+	for (size_t i = 0; i < entities.size(); i++)
+	{
+		const Transform* transform = m_Transforms.find(entities[i]);
+
+		if (transform)
+		{
+			m_NextItemEntities.push_back(entities[i]);
+			m_NextItemBoxes.push_back(bounds[i].m_Box.transform(transform->m_ModelMatrix));
+		}
+	}
+
+	// Any change of the items (or of their order, after a removal or "compact") rebuilds the tree.
+	if (m_NextItemEntities != m_ItemEntities)
+	{
+		m_ItemEntities.swap(m_NextItemEntities);
+		m_ItemBoxes.swap(m_NextItemBoxes);
+		m_Hierarchy.build(m_ItemBoxes);
+
+		m_EntityItems.assign(m_Generations.size(), s_NoItem);
+
+		for (unsigned int i = 0; i < m_ItemEntities.size(); i++)
+		{
+			m_EntityItems[getEntityIndex(m_ItemEntities[i])] = i;
+		}
+
+		return;
+	}
+
+	// Otherwise only the moved items are refitted.
+	for (unsigned int i = 0; i < m_ItemBoxes.size(); i++)
+	{
+		const BoundingBox& box = m_NextItemBoxes[i];
+
+		if (box.m_Min != m_ItemBoxes[i].m_Min || box.m_Max != m_ItemBoxes[i].m_Max)
+		{
+			m_ItemBoxes[i] = box;
+			m_Hierarchy.update(i, box);
+		}
+	}
+
+	m_Hierarchy.refit();
+}
+
+void EntityRegistry::beginFrame()
+{
+	m_LastNumberOfPackets = m_NumberOfPackets;
+	m_NumberOfPackets = 0;
+}
+
+void EntityRegistry::submit(RenderQueue& renderQueue, const glm::mat4& viewProjectionMatrix, const unsigned int pass, OcclusionCuller* occlusionCuller)
+{
+	const std::vector<Entity>& entities = m_Meshes.getEntities();
+	const std::vector<MeshRef>& meshes = m_Meshes.getComponents();
+
+	// 1. Cull the hierarchy, it holds the bounds of every pass.
+	Frustum frustum(viewProjectionMatrix);
+
+	m_VisibleItems.clear();
+	m_Hierarchy.cull(frustum, m_VisibleItems);
+
+	m_Visibility.assign(m_ItemEntities.size(), 0);
+
+	for (unsigned int item : m_VisibleItems)
+	{
+		m_Visibility[item] = 1;
+	}
+
+	// 2. Gather the packets of the pass that survived, bounds added since "updateBounds" aren't culled yet.
+	unsigned int numberOfVisible = 0, numberOfCulled = 0;
+
+	m_Packets.clear();
+
+	for (size_t i = 0; i < entities.size(); i++)
+	{
+		Entity entity = entities[i];
+		const Transform* transform = m_Transforms.find(entity);
+		const MaterialRef* materialRef = m_MaterialRefs.find(entity);
+
+		if (!transform || !materialRef || m_Materials[materialRef->m_Material].m_Pass != pass)
+		{
+			continue;
+		}
+
+		unsigned int index = getEntityIndex(entity);
+		unsigned int item = index < m_EntityItems.size() ? m_EntityItems[index] : s_NoItem;
+
+		if (item != s_NoItem && m_ItemEntities[item] == entity)
+		{
+			if (!m_Visibility[item])
+			{
+				numberOfCulled++;
+
+				continue;
+			}
+
+			numberOfVisible++;
+		}
+
+		const Bounds* bounds = m_Bounds.find(entity);
+
+		m_Packets.push_back({ (unsigned int)i, materialRef->m_Material, &transform->m_ModelMatrix, bounds ? &bounds->m_Box : nullptr });
+	}
+
+	Frustum::record(numberOfVisible, numberOfCulled);
+
+	// 3. Turn the packets into draw items.
+	for (const DrawPacket& packet : m_Packets)
+	{
+		const Material& material = m_Materials[packet.m_Material];
+		const MeshRef& mesh = meshes[packet.m_Mesh];
+		glm::vec3 center = glm::vec3((*packet.m_ModelMatrix)[3]);
+
+		if (packet.m_Box)
+		{
+			if (occlusionCuller && occlusionCuller->isOccluded(*packet.m_Box, *packet.m_ModelMatrix))
+			{
+				continue;
+			}
+
+			center = glm::vec3(*packet.m_ModelMatrix * glm::vec4((packet.m_Box->m_Min + packet.m_Box->m_Max) * 0.5f, 1.0f));
+		}
+
+		glm::vec4 clip = viewProjectionMatrix * glm::vec4(center, 1.0f);
+		float depth = clip.w > 0.0f ? clip.z / clip.w * 0.5f + 0.5f : 0.0f;
+
+		DrawItem item = {};
+
+		item.m_Key = RenderQueue::makeKey(pass, material.m_Program->getID(), material.m_ID, mesh.m_VertexArrayID, depth);
+		item.m_Program = material.m_Program;
+		item.m_VertexArrayID = mesh.m_VertexArrayID;
+		item.m_Mode = mesh.m_Mode;
+		item.m_First = mesh.m_First;
+		item.m_Count = mesh.m_Count;
+		item.m_Indexed = mesh.m_Indexed;
+		item.m_ModelMatrix = *packet.m_ModelMatrix;
+		item.m_ModelMatrixHandle = material.m_ModelMatrixHandle;
+		item.m_Setup = material.m_Setup;
+
+		renderQueue.submit(std::move(item), material.m_Textures.data(), (unsigned int)material.m_Textures.size());
+
+		m_NumberOfPackets++;
+	}
+}
+
+void EntityRegistry::compact()
+{
+	m_Transforms.sortAs(m_Meshes);
+	m_MaterialRefs.sortAs(m_Meshes);
+	m_Bounds.sortAs(m_Meshes);
+}
+
+Entity EntityRegistry::pick(const glm::vec3& origin, const glm::vec3& direction, float& distance) const
+{
+	unsigned int item;
+
+	if (!m_Hierarchy.raycast(origin, direction, item, distance, true))
+	{
+		return s_NullEntity;
+	}
+
+	return m_ItemEntities[item];
+}
+
+ComponentPool<Transform>& EntityRegistry::getTransforms()
+{
+	return m_Transforms;
+}
+
+ComponentPool<MeshRef>& EntityRegistry::getMeshes()
+{
+	return m_Meshes;
+}
+
+ComponentPool<MaterialRef>& EntityRegistry::getMaterialRefs()
+{
+	return m_MaterialRefs;
+}
+
+ComponentPool<Bounds>& EntityRegistry::getBounds()
+{
+	return m_Bounds;
+}
+
+ComponentPool<LightSource>& EntityRegistry::getLights()
+{
+	return m_Lights;
+}
+
+size_t EntityRegistry::getNumberOfEntities() const
+{
+	return m_NumberOfEntities;
+}
+
+size_t EntityRegistry::getNumberOfPackets() const
+{
+	return m_LastNumberOfPackets;
+}
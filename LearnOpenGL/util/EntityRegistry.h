@@ -0,0 +1,289 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <functional>
+
+#include <glm/glm.hpp>
+
+#include "Frustum.h"
+#include "SceneGraph.h"
+#include "BoundingVolumeHierarchy.h"
+#include "OcclusionCuller.h"
+#include "../core/RenderQueue.h"
+#include "../core/ShaderProgram.h"
+
+// Index in the low 24 bits, generation in the high 8 bits (it tells reused indices apart).
+using Entity = unsigned int;
+
+inline unsigned int getEntityIndex(const Entity entity)
+{
+	return entity & 0x00FFFFFF;
+}
+
+// Components of the entities of one type, in a sparse set: the components are packed in a dense
+// array (iterated as is by the systems), and a sparse array indexed by entity points into it.
+// Removing a component moves the last one into its place, so the order isn't stable.
+template <typename T>
+class ComponentPool
+{
+public:
+	ComponentPool() : m_Sparse(), m_Entities(), m_Components()
+	{
+	}
+
+	// Replaces the component if the entity already has one.
+	T& add(const Entity entity, const T& component)
+	{
+		unsigned int index = getEntityIndex(entity);
+
+		if (index >= m_Sparse.size())
+		{
+			m_Sparse.resize((size_t)index + 1, s_Invalid);
+		}
+
+		if (m_Sparse[index] != s_Invalid)
+		{
+			m_Entities[m_Sparse[index]] = entity;
+
+			return m_Components[m_Sparse[index]] = component;
+		}
+
+		m_Sparse[index] = (unsigned int)m_Entities.size();
+		m_Entities.push_back(entity);
+		m_Components.push_back(component);
+
+		return m_Components.back();
+	}
+
+	void remove(const Entity entity)
+	{
+		if (!has(entity))
+		{
+			return;
+		}
+
+		unsigned int position = m_Sparse[getEntityIndex(entity)];
+		unsigned int last = (unsigned int)m_Entities.size() - 1;
+
+		if (position != last)
+		{
+			swap(position, last);
+		}
+
+		m_Sparse[getEntityIndex(entity)] = s_Invalid;
+		m_Entities.pop_back();
+		m_Components.pop_back();
+	}
+
+	bool has(const Entity entity) const
+	{
+		unsigned int index = getEntityIndex(entity);
+
+		return index < m_Sparse.size() && m_Sparse[index] != s_Invalid && m_Entities[m_Sparse[index]] == entity;
+	}
+
+	// The entity must have the component.
+	T& get(const Entity entity)
+	{
+		return m_Components[m_Sparse[getEntityIndex(entity)]];
+	}
+
+	// Null if the entity doesn't have the component.
+	T* find(const Entity entity)
+	{
+		return has(entity) ? &m_Components[m_Sparse[getEntityIndex(entity)]] : nullptr;
+	}
+
+	// Moves the entities shared with "other" to the front, in the order of "other", so that
+	// iterating both together reads each dense array sequentially.
+	template <typename U>
+	void sortAs(const ComponentPool<U>& other)
+	{
+		unsigned int position = 0;
+
+		for (Entity entity : other.getEntities())
+		{
+			if (!has(entity))
+			{
+				continue;
+			}
+
+			unsigned int current = m_Sparse[getEntityIndex(entity)];
+
+			if (current != position)
+			{
+				swap(current, position);
+			}
+
+			position++;
+		}
+	}
+
+	void clear()
+	{
+		m_Sparse.clear();
+		m_Entities.clear();
+		m_Components.clear();
+	}
+
+	const std::vector<Entity>& getEntities() const
+	{
+		return m_Entities;
+	}
+
+	std::vector<T>& getComponents()
+	{
+		return m_Components;
+	}
+
+	size_t size() const
+	{
+		return m_Entities.size();
+	}
+
+private:
+	static constexpr unsigned int s_Invalid = 0xFFFFFFFF;
+
+	std::vector<unsigned int> m_Sparse; // Per entity index, position in the dense arrays.
+	std::vector<Entity> m_Entities; // Dense.
+	std::vector<T> m_Components; // Dense.
+
+	void swap(const unsigned int a, const unsigned int b)
+	{
+		std::swap(m_Entities[a], m_Entities[b]);
+		std::swap(m_Components[a], m_Components[b]);
+
+		m_Sparse[getEntityIndex(m_Entities[a])] = a;
+		m_Sparse[getEntityIndex(m_Entities[b])] = b;
+	}
+};
+
+struct Transform
+{
+	glm::mat4 m_ModelMatrix;
+	unsigned int m_Node; // Scene graph node it follows (see "EntityRegistry::updateTransforms"), or "SceneGraph::s_NoParent".
+};
+
+struct MeshRef
+{
+	unsigned int m_VertexArrayID;
+	unsigned int m_Mode;
+	int m_First, m_Count; // See "DrawItem".
+	bool m_Indexed;
+};
+
+struct MaterialRef
+{
+	unsigned int m_Material; // Returned by "EntityRegistry::addMaterial".
+};
+
+struct Bounds
+{
+	BoundingBox m_Box; // In model space, not empty. Entities without bounds are never culled.
+};
+
+struct LightSource
+{
+	glm::vec3 m_Color;
+	float m_Constant, m_Linear, m_Quadratic;
+};
+
+// Shared by every entity referencing it, the draws of a material only differ by their mesh
+// and model matrix.
+struct Material
+{
+	ShaderProgram* m_Program = nullptr;
+	UniformHandle m_ModelMatrixHandle;
+	unsigned int m_Pass = 0; // Only submitted along with the other materials of the pass.
+	std::vector<TextureBinding> m_Textures;
+	std::function<void(ShaderProgram*)> m_Setup; // Any other uniform, optional.
+
+	unsigned int m_ID = 0; // See "RenderQueue::getMaterialID", set by "addMaterial".
+};
+
+// Renderable instances as entities with components, each component type in its own pool (a
+// structure of arrays per type). Systems walk the dense arrays instead of per-object code: a
+// draw is submitted for every entity with a transform, a mesh and a material of the pass.
+//
+// The world bounds of the entities with a transform are kept in a bounding volume hierarchy by
+// "updateBounds": moved entities only refit it, it's rebuilt when bounds are added or removed.
+// Submitting a pass culls the hierarchy, gathers the packets of the visible entities (the dense
+// position of the mesh and the material), then turns them into draw items keyed by the depth of
+// their center, testing them against the optional occlusion culler on the way. Picking goes
+// through the same hierarchy. "compact" sorts the pools after the meshes, once entities churned.
+class EntityRegistry
+{
+public:
+	EntityRegistry();
+
+	Entity create();
+	void destroy(const Entity entity); // With all of its components.
+	bool isAlive(const Entity entity) const;
+
+	unsigned int addMaterial(Material material);
+	Material& getMaterial(const unsigned int material);
+
+	// Copies the world matrices of the followed scene graph nodes, the graph must be up to date.
+	void updateTransforms(const SceneGraph& sceneGraph);
+
+	// After the transforms, culling and picking use the bounds as of the last call.
+	void updateBounds();
+
+	void beginFrame();
+	void submit(RenderQueue& renderQueue, const glm::mat4& viewProjectionMatrix, const unsigned int pass, OcclusionCuller* occlusionCuller = nullptr);
+	void compact();
+
+	// Nearest entity whose world bounds the ray hits, "s_NullEntity" if none. Bounds containing
+	// the origin are ignored, e.g. those of a room around the camera.
+	Entity pick(const glm::vec3& origin, const glm::vec3& direction, float& distance) const;
+
+	ComponentPool<Transform>& getTransforms();
+	ComponentPool<MeshRef>& getMeshes();
+	ComponentPool<MaterialRef>& getMaterialRefs();
+	ComponentPool<Bounds>& getBounds();
+	ComponentPool<LightSource>& getLights();
+
+	size_t getNumberOfEntities() const;
+	size_t getNumberOfPackets() const; // Submitted during the last complete frame.
+
+	static const Entity s_NullEntity = 0xFFFFFFFF; // Never alive.
+	static const unsigned int s_MaxEntities = 0x00FFFFFF;
+
+private:
+	struct DrawPacket
+	{
+		unsigned int m_Mesh; // Dense position in the mesh pool.
+		unsigned int m_Material;
+		const glm::mat4* m_ModelMatrix;
+		const BoundingBox* m_Box; // Model space, null when unbounded.
+	};
+
+	static constexpr unsigned int s_NoItem = 0xFFFFFFFF;
+
+	ComponentPool<Transform> m_Transforms;
+	ComponentPool<MeshRef> m_Meshes;
+	ComponentPool<MaterialRef> m_MaterialRefs;
+	ComponentPool<Bounds> m_Bounds;
+	ComponentPool<LightSource> m_Lights;
+
+	std::vector<Material> m_Materials;
+
+	std::vector<unsigned char> m_Generations; // Per entity index.
+	std::vector<unsigned int> m_FreeIndices;
+	size_t m_NumberOfEntities;
+
+	BoundingVolumeHierarchy m_Hierarchy;
+	std::vector<Entity> m_ItemEntities; // Per hierarchy item.
+	std::vector<BoundingBox> m_ItemBoxes; // Per hierarchy item, world space.
+	std::vector<unsigned int> m_EntityItems; // Per entity index, hierarchy item or "s_NoItem".
+
+	// Kept across frames, neither updating nor submitting allocates.
+	std::vector<Entity> m_NextItemEntities;
+	std::vector<BoundingBox> m_NextItemBoxes;
+	std::vector<DrawPacket> m_Packets;
+	std::vector<unsigned int> m_VisibleItems;
+	std::vector<unsigned char> m_Visibility; // Per hierarchy item.
+	size_t m_NumberOfPackets, m_LastNumberOfPackets;
+};
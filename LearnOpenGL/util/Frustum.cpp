@@ -0,0 +1,296 @@
+#include "Frustum.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_SIMD_WIDTH 4
+#else
+#define FRUSTUM_SIMD_WIDTH 1
+#endif
+
+Frustum::Statistics Frustum::s_Statistics = {};
+Frustum::Statistics Frustum::s_LastStatistics = {};
+
+void BoundingBox::extend(const glm::vec3& point)
+{
+	m_Min = glm::min(m_Min, point);
+	m_Max = glm::max(m_Max, point);
+}
+
+void BoundingBox::extend(const BoundingBox& box)
+{
+	m_Min = glm::min(m_Min, box.m_Min);
+	m_Max = glm::max(m_Max, box.m_Max);
+}
+
+BoundingBox BoundingBox::transform(const glm::mat4& matrix) const
+{
+	if (isEmpty())
+	{
+		return *this;
+	}
+
+	// Arvo's method: the extent along each axis is the sum of the absolute contributions.
+	glm::vec3 center = (m_Min + m_Max) * 0.5f;
+	glm::vec3 extent = (m_Max - m_Min) * 0.5f;
+	glm::vec3 transformedCenter(matrix[3]), transformedExtent(0.0f);
+
+	for (int i = 0; i < 3; i++)
+	{
+		transformedCenter += glm::vec3(matrix[i]) * center[i];
+		transformedExtent += glm::vec3(std::fabs(matrix[i].x), std::fabs(matrix[i].y), std::fabs(matrix[i].z)) * extent[i];
+	}
+
+	return { transformedCenter - transformedExtent, transformedCenter + transformedExtent };
+}
+
+bool BoundingBox::isEmpty() const
+{
+	return m_Min.x > m_Max.x || m_Min.y > m_Max.y || m_Min.z > m_Max.z;
+}
+
+BoundingBoxSet::BoundingBoxSet()
+	: m_CenterX(), m_CenterY(), m_CenterZ(), m_ExtentX(), m_ExtentY(), m_ExtentZ()
+{
+}
+
+void BoundingBoxSet::add(const BoundingBox& box)
+{
+	// An empty box has no geometry to draw, a negative extent makes it fail every plane.
+	glm::vec3 center = box.isEmpty() ? glm::vec3(0.0f) : (box.m_Min + box.m_Max) * 0.5f;
+	glm::vec3 extent = box.isEmpty() ? glm::vec3(-FLT_MAX) : (box.m_Max - box.m_Min) * 0.5f;
+
+	m_CenterX.push_back(center.x);
+	m_CenterY.push_back(center.y);
+	m_CenterZ.push_back(center.z);
+	m_ExtentX.push_back(extent.x);
+	m_ExtentY.push_back(extent.y);
+	m_ExtentZ.push_back(extent.z);
+}
+
+void BoundingBoxSet::clear()
+{
+	m_CenterX.clear();
+	m_CenterY.clear();
+	m_CenterZ.clear();
+	m_ExtentX.clear();
+	m_ExtentY.clear();
+	m_ExtentZ.clear();
+}
+
+size_t BoundingBoxSet::size() const
+{
+	return m_CenterX.size();
+}
+
+Frustum::Frustum()
+	: m_Planes()
+{
+}
+
+Frustum::Frustum(const glm::mat4& matrix)
+	: m_Planes()
+{
+	update(matrix);
+}
+
+void Frustum::update(const glm::mat4& matrix)
+{
+	// Gribb-Hartmann extraction, each plane is the last row plus or minus another one.
+	glm::vec4 rows[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+	}
+
+	m_Planes[LEFT_PLANE] = rows[3] + rows[0];
+	m_Planes[RIGHT_PLANE] = rows[3] - rows[0];
+	m_Planes[BOTTOM_PLANE] = rows[3] + rows[1];
+	m_Planes[TOP_PLANE] = rows[3] - rows[1];
+	m_Planes[NEAR_PLANE] = rows[3] + rows[2];
+	m_Planes[FAR_PLANE] = rows[3] - rows[2];
+
+	normalize();
+}
+
+Frustum Frustum::transform(const glm::mat4& modelMatrix) const
+{
+	Frustum frustum;
+
+	// A point "p" of the model is inside when "plane * modelMatrix * p" is positive.
+	for (int i = 0; i < NUMBER_OF_PLANES; i++)
+	{
+		frustum.m_Planes[i] = m_Planes[i] * modelMatrix;
+	}
+
+	frustum.normalize();
+
+	return frustum;
+}
+
+bool Frustum::isVisible(const BoundingBox& box) const
+{
+	bool visible = !box.isEmpty();
+
+	if (visible)
+	{
+		glm::vec3 center = (box.m_Min + box.m_Max) * 0.5f;
+		glm::vec3 extent = (box.m_Max - box.m_Min) * 0.5f;
+
+		visible = isVisible(center.x, center.y, center.z, extent.x, extent.y, extent.z);
+	}
+
+	(visible ? s_Statistics.m_Visible : s_Statistics.m_Culled)++;
+
+	return visible;
+}
+
+Frustum::Containment Frustum::getContainment(const BoundingBox& box) const
+{
+	glm::vec3 center = (box.m_Min + box.m_Max) * 0.5f;
+	glm::vec3 extent = (box.m_Max - box.m_Min) * 0.5f;
+	Containment containment = Containment::INSIDE;
+
+	for (const glm::vec4& plane : m_Planes)
+	{
+		// Summed in the same order as the batched tests, so both always agree.
+		float distance = (center.x * plane.x + center.y * plane.y) + (center.z * plane.z + plane.w);
+		float radius = (extent.x * std::abs(plane.x) + extent.y * std::abs(plane.y)) + extent.z * std::abs(plane.z);
+
+		if (distance + radius < 0.0f)
+		{
+			return Containment::OUTSIDE;
+		}
+
+		// The corner nearest along the normal is behind the plane.
+		if (distance - radius < 0.0f)
+		{
+			containment = Containment::INTERSECTING;
+		}
+	}
+
+	return containment;
+}
+
+size_t Frustum::cull(const BoundingBoxSet& boxes, unsigned char* visibility) const
+{
+	size_t numberOfBoxes = boxes.size();
+	size_t numberOfVisibleBoxes = 0;
+	size_t i = 0;
+
+#if FRUSTUM_SIMD_WIDTH == 8
+	for (; i + 8 <= numberOfBoxes; i += 8)
+	{
+		__m256 centerX = _mm256_loadu_ps(&boxes.m_CenterX[i]), centerY = _mm256_loadu_ps(&boxes.m_CenterY[i]), centerZ = _mm256_loadu_ps(&boxes.m_CenterZ[i]);
+		__m256 extentX = _mm256_loadu_ps(&boxes.m_ExtentX[i]), extentY = _mm256_loadu_ps(&boxes.m_ExtentY[i]), extentZ = _mm256_loadu_ps(&boxes.m_ExtentZ[i]);
+		__m256 outside = _mm256_setzero_ps();
+
+		for (const glm::vec4& plane : m_Planes)
+		{
+			// Distance of the center, and projected radius of the box on the normal.
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(centerX, _mm256_set1_ps(plane.x)), _mm256_mul_ps(centerY, _mm256_set1_ps(plane.y))),
+				_mm256_add_ps(_mm256_mul_ps(centerZ, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extentX, _mm256_set1_ps(std::abs(plane.x))), _mm256_mul_ps(extentY, _mm256_set1_ps(std::abs(plane.y)))),
+				_mm256_mul_ps(extentZ, _mm256_set1_ps(std::abs(plane.z))));
+
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+
+		int outsideMask = _mm256_movemask_ps(outside);
+
+		for (int j = 0; j < 8; j++)
+		{
+			visibility[i + j] = (outsideMask >> j) & 1 ? 0 : 1;
+			numberOfVisibleBoxes += visibility[i + j];
+		}
+	}
+#elif FRUSTUM_SIMD_WIDTH == 4
+	for (; i + 4 <= numberOfBoxes; i += 4)
+	{
+		__m128 centerX = _mm_loadu_ps(&boxes.m_CenterX[i]), centerY = _mm_loadu_ps(&boxes.m_CenterY[i]), centerZ = _mm_loadu_ps(&boxes.m_CenterZ[i]);
+		__m128 extentX = _mm_loadu_ps(&boxes.m_ExtentX[i]), extentY = _mm_loadu_ps(&boxes.m_ExtentY[i]), extentZ = _mm_loadu_ps(&boxes.m_ExtentZ[i]);
+		__m128 outside = _mm_setzero_ps();
+
+		for (const glm::vec4& plane : m_Planes)
+		{
+			// Distance of the center, and projected radius of the box on the normal.
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.x)), _mm_mul_ps(centerY, _mm_set1_ps(plane.y))),
+				_mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, _mm_set1_ps(std::abs(plane.x))), _mm_mul_ps(extentY, _mm_set1_ps(std::abs(plane.y)))),
+				_mm_mul_ps(extentZ, _mm_set1_ps(std::abs(plane.z))));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		int outsideMask = _mm_movemask_ps(outside);
+
+		for (int j = 0; j < 4; j++)
+		{
+			visibility[i + j] = (outsideMask >> j) & 1 ? 0 : 1;
+			numberOfVisibleBoxes += visibility[i + j];
+		}
+	}
+#endif
+
+	// What's left of the last batch.
+	for (; i < numberOfBoxes; i++)
+	{
+		visibility[i] = isVisible(boxes.m_CenterX[i], boxes.m_CenterY[i], boxes.m_CenterZ[i], boxes.m_ExtentX[i], boxes.m_ExtentY[i], boxes.m_ExtentZ[i]) ? 1 : 0;
+		numberOfVisibleBoxes += visibility[i];
+	}
+
+	s_Statistics.m_Visible += (unsigned int)numberOfVisibleBoxes;
+	s_Statistics.m_Culled += (unsigned int)(numberOfBoxes - numberOfVisibleBoxes);
+
+	return numberOfVisibleBoxes;
+}
+
+void Frustum::record(const unsigned int visible, const unsigned int culled)
+{
+	s_Statistics.m_Visible += visible;
+	s_Statistics.m_Culled += culled;
+}
+
+void Frustum::beginFrame()
+{
+	s_LastStatistics = s_Statistics;
+	s_Statistics = {};
+}
+
+const Frustum::Statistics& Frustum::getStatistics()
+{
+	return s_LastStatistics;
+}
+
+void Frustum::normalize()
+{
+	for (glm::vec4& plane : m_Planes)
+	{
+		float length = glm::length(glm::vec3(plane));
+
+		if (length > 0.0f)
+		{
+			plane /= length;
+		}
+	}
+}
+
+bool Frustum::isVisible(const float centerX, const float centerY, const float centerZ, const float extentX, const float extentY, const float extentZ) const
+{
+	// The box is outside as soon as its corner furthest along a normal is behind that plane.
+	for (const glm::vec4& plane : m_Planes)
+	{
+		float distance = (centerX * plane.x + centerY * plane.y) + (centerZ * plane.z + plane.w);
+		float radius = (extentX * std::abs(plane.x) + extentY * std::abs(plane.y)) + extentZ * std::abs(plane.z);
+
+		if (distance + radius < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
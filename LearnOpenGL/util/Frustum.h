@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+struct BoundingBox
+{
+	glm::vec3 m_Min = glm::vec3(FLT_MAX);
+	glm::vec3 m_Max = glm::vec3(-FLT_MAX);
+
+	void extend(const glm::vec3& point);
+	void extend(const BoundingBox& box);
+
+	BoundingBox transform(const glm::mat4& matrix) const; // Box around the transformed box.
+
+	bool isEmpty() const;
+};
+
+// Bounding boxes stored as center and extent arrays (structure of arrays), so that the frustum
+// tests a batch of them per SIMD instruction.
+class BoundingBoxSet
+{
+public:
+	BoundingBoxSet();
+
+	void add(const BoundingBox& box);
+	void clear();
+
+	size_t size() const;
+
+private:
+	friend class Frustum;
+
+	std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+	std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ;
+};
+
+// The six planes bounding the volume seen through a view-projection matrix. Built from a
+// matrix that also includes a model matrix (or moved with "transform"), the planes are in
+// that model's space and its local bounds are tested as they are.
+//
+// Batches are tested 8 boxes at a time with AVX, 4 with SSE, and one by one otherwise.
+class Frustum
+{
+public:
+	enum class Containment { OUTSIDE, INTERSECTING, INSIDE };
+
+	struct Statistics
+	{
+		unsigned int m_Visible;
+		unsigned int m_Culled;
+	};
+
+	Frustum();
+	explicit Frustum(const glm::mat4& matrix);
+
+	void update(const glm::mat4& matrix);
+	Frustum transform(const glm::mat4& modelMatrix) const;
+
+	bool isVisible(const BoundingBox& box) const;
+
+	// Not counted in the statistics, meant for hierarchies testing nodes rather than objects.
+	Containment getContainment(const BoundingBox& box) const;
+
+	// Writes 1 (visible) or 0 per box, returns the number of visible boxes.
+	size_t cull(const BoundingBoxSet& boxes, unsigned char* visibility) const;
+
+	static void record(const unsigned int visible, const unsigned int culled);
+	static void beginFrame();
+	static const Statistics& getStatistics(); // Of the last complete frame.
+
+private:
+	// Not "NEAR" and "FAR", Windows headers define both as macros.
+	enum { LEFT_PLANE, RIGHT_PLANE, BOTTOM_PLANE, TOP_PLANE, NEAR_PLANE, FAR_PLANE, NUMBER_OF_PLANES };
+
+	glm::vec4 m_Planes[NUMBER_OF_PLANES]; // Normals point inside, "dot(normal, p) + w >= 0" is inside.
+
+	static Statistics s_Statistics, s_LastStatistics;
+
+	void normalize();
+	bool isVisible(const float centerX, const float centerY, const float centerZ, const float extentX, const float extentY, const float extentZ) const;
+};
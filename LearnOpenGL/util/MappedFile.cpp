@@ -0,0 +1,135 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& filepath)
+	: m_Data(), m_Size(), m_File(INVALID_HANDLE_VALUE), m_Mapping()
+{
+	LARGE_INTEGER size;
+
+	m_File = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	// A missing file isn't an error, callers check "isOpen".
+	if (m_File == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+	{
+		return;
+	}
+
+	m_Mapping = CreateFileMappingA(m_File, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (m_Mapping)
+	{
+		m_Data = (const unsigned char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+
+	if (m_Data)
+	{
+		m_Size = (size_t)size.QuadPart;
+	}
+	else
+	{
+		std::cout << "[ERROR] MAPPED FILE: Failed to map \"" << filepath << "\"." << std::endl;
+	}
+}
+
+void MappedFile::close()
+{
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+	}
+
+	if (m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+	}
+
+	if (m_File != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_File);
+	}
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Mapping = nullptr;
+	m_File = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filepath)
+	: m_Data(), m_Size(), m_File(-1)
+{
+	struct stat status;
+
+	m_File = open(filepath.c_str(), O_RDONLY);
+
+	// A missing file isn't an error, callers check "isOpen".
+	if (m_File < 0 || fstat(m_File, &status) != 0 || status.st_size == 0)
+	{
+		return;
+	}
+
+	void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, m_File, 0);
+
+	if (data != MAP_FAILED)
+	{
+		m_Data = (const unsigned char*)data;
+		m_Size = (size_t)status.st_size;
+	}
+	else
+	{
+		std::cout << "[ERROR] MAPPED FILE: Failed to map \"" << filepath << "\"." << std::endl;
+	}
+}
+
+void MappedFile::close()
+{
+	if (m_Data)
+	{
+		munmap((void*)m_Data, m_Size);
+	}
+
+	if (m_File >= 0)
+	{
+		::close(m_File);
+	}
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_File = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::isOpen() const
+{
+	return m_Data != nullptr;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+	return m_Data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return m_Size;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <iostream>
+
+// Read-only memory mapping of a whole file.
+//
+// The pages are only read from the disk once accessed, and stay in the OS file cache, so
+// loading data from a mapped file avoids both the copy into a buffer and reading unused parts.
+class MappedFile
+{
+public:
+	MappedFile(const std::string& filepath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Unmaps the file early, e.g. before replacing it (Windows can't rename over a mapped file).
+	void close();
+
+	bool isOpen() const;
+
+	const unsigned char* getData() const;
+	size_t getSize() const;
+
+private:
+	const unsigned char* m_Data;
+	size_t m_Size;
+
+#if defined(_WIN32)
+	void* m_File;
+	void* m_Mapping;
+#else
+	int m_File;
+#endif
+};
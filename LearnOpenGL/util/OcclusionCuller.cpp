@@ -0,0 +1,303 @@
+#include "OcclusionCuller.h"
+
+OcclusionCuller::OcclusionCuller(const int width, const int height)
+	: m_Width(width), m_Height(height), m_Readbacks(), m_NextReadback(0), m_Depth(), m_DepthViewProjectionMatrix(1.0f), m_DepthAvailable(false),
+	  m_Levels(), m_LevelSizes(), m_ViewProjectionMatrix(1.0f), m_Statistics(), m_LastStatistics()
+{
+	size_t size = (size_t)width * height * sizeof(float);
+
+	for (Readback& readback : m_Readbacks)
+	{
+		glGenBuffers(1, &readback.m_PBO);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.m_PBO);
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+
+		ResourceTracker::track(ResourceTracker::Category::BUFFER, readback.m_PBO, size);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	// Every level halves the previous one (rounding up) down to a single texel.
+	glm::ivec2 levelSize((width + s_Downsampling - 1) / s_Downsampling, (height + s_Downsampling - 1) / s_Downsampling);
+
+	m_Depth.resize((size_t)levelSize.x * levelSize.y);
+
+	while (true)
+	{
+		m_LevelSizes.push_back(levelSize);
+		m_Levels.emplace_back((size_t)levelSize.x * levelSize.y, 1.0f);
+
+		if (levelSize.x == 1 && levelSize.y == 1)
+		{
+			break;
+		}
+
+		levelSize = glm::max((levelSize + 1) / 2, glm::ivec2(1));
+	}
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+	for (Readback& readback : m_Readbacks)
+	{
+		if (readback.m_Fence)
+		{
+			glDeleteSync(readback.m_Fence);
+		}
+
+		ResourceTracker::untrack(ResourceTracker::Category::BUFFER, readback.m_PBO);
+
+		glDeleteBuffers(1, &readback.m_PBO);
+	}
+}
+
+void OcclusionCuller::readDepth(const unsigned int framebufferID, const glm::mat4& viewProjectionMatrix)
+{
+	Readback& readback = m_Readbacks[m_NextReadback];
+
+	if (readback.m_Fence)
+	{
+		return;
+	}
+
+	GLStateCache::bindFramebuffer(GL_READ_FRAMEBUFFER, framebufferID);
+
+	// Into the buffer, so the call returns without waiting for the frame to be drawn.
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.m_PBO);
+	glReadPixels(0, 0, m_Width, m_Height, GL_DEPTH_COMPONENT, GL_FLOAT, (void*)0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	readback.m_Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.m_ViewProjectionMatrix = viewProjectionMatrix;
+
+	m_NextReadback = (m_NextReadback + 1) % s_NumberOfReadbacks;
+}
+
+void OcclusionCuller::update(const glm::mat4& viewProjectionMatrix)
+{
+	m_LastStatistics = m_Statistics;
+	m_Statistics = {};
+
+	// From the oldest readback in flight to the newest, the last completed one wins.
+	for (int i = 0; i < s_NumberOfReadbacks; i++)
+	{
+		Readback& readback = m_Readbacks[(m_NextReadback + i) % s_NumberOfReadbacks];
+
+		if (!readback.m_Fence)
+		{
+			continue;
+		}
+
+		GLenum status = glClientWaitSync(readback.m_Fence, 0, 0);
+
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+
+		glDeleteSync(readback.m_Fence);
+		readback.m_Fence = nullptr;
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.m_PBO);
+
+		const float* depth = (const float*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (size_t)m_Width * m_Height * sizeof(float), GL_MAP_READ_BIT);
+
+		if (depth)
+		{
+			reduceReadback(depth);
+
+			m_DepthViewProjectionMatrix = readback.m_ViewProjectionMatrix;
+			m_DepthAvailable = true;
+		}
+
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	m_ViewProjectionMatrix = viewProjectionMatrix;
+
+	if (m_DepthAvailable)
+	{
+		reproject();
+		buildPyramid();
+	}
+}
+
+bool OcclusionCuller::isOccluded(const BoundingBox& box, const glm::mat4& modelMatrix)
+{
+	if (!m_DepthAvailable || box.isEmpty())
+	{
+		return false;
+	}
+
+	glm::mat4 matrix = m_ViewProjectionMatrix * modelMatrix;
+	glm::vec3 minimum(FLT_MAX), maximum(-FLT_MAX); // Of the corners, in normalized device coordinates.
+
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner(i & 1 ? box.m_Max.x : box.m_Min.x, i & 2 ? box.m_Max.y : box.m_Min.y, i & 4 ? box.m_Max.z : box.m_Min.z);
+		glm::vec4 clip = matrix * glm::vec4(corner, 1.0f);
+
+		// Crossing the near plane, the projection is meaningless (and the box is close anyway).
+		if (clip.w <= 0.0f)
+		{
+			return false;
+		}
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+		minimum = glm::min(minimum, ndc);
+		maximum = glm::max(maximum, ndc);
+	}
+
+	m_Statistics.m_Tested++;
+
+	// Outside of the screen, that's for the frustum to decide.
+	if (maximum.x < -1.0f || maximum.y < -1.0f || minimum.x > 1.0f || minimum.y > 1.0f)
+	{
+		return false;
+	}
+
+	glm::ivec2 baseSize = m_LevelSizes[0];
+	glm::ivec2 first = glm::clamp(glm::ivec2((glm::vec2(minimum) * 0.5f + 0.5f) * glm::vec2(baseSize)), glm::ivec2(0), baseSize - 1);
+	glm::ivec2 last = glm::clamp(glm::ivec2((glm::vec2(maximum) * 0.5f + 0.5f) * glm::vec2(baseSize)), glm::ivec2(0), baseSize - 1);
+
+	// The first level where the box covers at most 2x2 texels.
+	int level = 0;
+
+	while (level + 1 < (int)m_Levels.size() && ((last.x >> level) - (first.x >> level) > 1 || (last.y >> level) - (first.y >> level) > 1))
+	{
+		level++;
+	}
+
+	const std::vector<float>& depth = m_Levels[level];
+	int width = m_LevelSizes[level].x;
+	float farthest = 0.0f;
+
+	for (int y = first.y >> level; y <= last.y >> level; y++)
+	{
+		for (int x = first.x >> level; x <= last.x >> level; x++)
+		{
+			farthest = std::max(farthest, depth[(size_t)y * width + x]);
+		}
+	}
+
+	bool occluded = minimum.z * 0.5f + 0.5f > farthest;
+
+	if (occluded)
+	{
+		m_Statistics.m_Occluded++;
+	}
+
+	return occluded;
+}
+
+bool OcclusionCuller::isReady() const
+{
+	return m_DepthAvailable;
+}
+
+const OcclusionCuller::Statistics& OcclusionCuller::getStatistics() const
+{
+	return m_LastStatistics;
+}
+
+void OcclusionCuller::reduceReadback(const float* depth)
+{
+	glm::ivec2 size = m_LevelSizes[0];
+
+	for (int y = 0; y < size.y; y++)
+	{
+		for (int x = 0; x < size.x; x++)
+		{
+			float farthest = 0.0f;
+
+			for (int j = y * s_Downsampling; j < std::min((y + 1) * s_Downsampling, m_Height); j++)
+			{
+				for (int i = x * s_Downsampling; i < std::min((x + 1) * s_Downsampling, m_Width); i++)
+				{
+					farthest = std::max(farthest, depth[(size_t)j * m_Width + i]);
+				}
+			}
+
+			m_Depth[(size_t)y * size.x + x] = farthest;
+		}
+	}
+}
+
+void OcclusionCuller::reproject()
+{
+	glm::ivec2 size = m_LevelSizes[0];
+	glm::mat4 reprojection = m_ViewProjectionMatrix * glm::inverse(m_DepthViewProjectionMatrix);
+	std::vector<float>& base = m_Levels[0];
+
+	// Negative until a sample lands on the texel.
+	std::fill(base.begin(), base.end(), -1.0f);
+
+	for (int y = 0; y < size.y; y++)
+	{
+		for (int x = 0; x < size.x; x++)
+		{
+			float depth = m_Depth[(size_t)y * size.x + x];
+
+			// Nothing was drawn there, the texel can't occlude anything.
+			if (depth >= 1.0f)
+			{
+				continue;
+			}
+
+			glm::vec4 ndc((x + 0.5f) / size.x * 2.0f - 1.0f, (y + 0.5f) / size.y * 2.0f - 1.0f, depth * 2.0f - 1.0f, 1.0f);
+			glm::vec4 clip = reprojection * ndc;
+
+			if (clip.w <= 0.0f)
+			{
+				continue;
+			}
+
+			glm::vec3 reprojected = glm::vec3(clip) / clip.w;
+			int targetX = (int)std::floor((reprojected.x * 0.5f + 0.5f) * size.x);
+			int targetY = (int)std::floor((reprojected.y * 0.5f + 0.5f) * size.y);
+
+			if (targetX < 0 || targetY < 0 || targetX >= size.x || targetY >= size.y)
+			{
+				continue;
+			}
+
+			// Several samples on a texel keep the farthest one, to stay conservative.
+			float& texel = base[(size_t)targetY * size.x + targetX];
+
+			texel = std::max(texel, glm::clamp(reprojected.z * 0.5f + 0.5f, 0.0f, 1.0f));
+		}
+	}
+
+	for (float& texel : base)
+	{
+		if (texel < 0.0f)
+		{
+			texel = 1.0f;
+		}
+	}
+}
+
+void OcclusionCuller::buildPyramid()
+{
+	for (size_t level = 1; level < m_Levels.size(); level++)
+	{
+		const std::vector<float>& source = m_Levels[level - 1];
+		std::vector<float>& destination = m_Levels[level];
+		glm::ivec2 sourceSize = m_LevelSizes[level - 1], size = m_LevelSizes[level];
+
+		for (int y = 0; y < size.y; y++)
+		{
+			for (int x = 0; x < size.x; x++)
+			{
+				// Odd sizes leave the last texels with a single source texel per axis.
+				int x0 = 2 * x, x1 = std::min(2 * x + 1, sourceSize.x - 1);
+				int y0 = 2 * y, y1 = std::min(2 * y + 1, sourceSize.y - 1);
+
+				destination[(size_t)y * size.x + x] = std::max(std::max(source[(size_t)y0 * sourceSize.x + x0], source[(size_t)y0 * sourceSize.x + x1]),
+					std::max(source[(size_t)y1 * sourceSize.x + x0], source[(size_t)y1 * sourceSize.x + x1]));
+			}
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "Frustum.h"
+#include "../core/ResourceTracker.h"
+#include "../core/GLStateCache.h"
+
+// CPU reference implementation of hierarchical-Z (Hi-Z) occlusion culling.
+//
+// The depth of a past frame is read back asynchronously (through a ring of pixel pack buffers
+// guarded by fences, so reading never stalls), reduced to 1/s_Downsampling of its size keeping
+// the farthest depth, then reprojected into the current view and reduced again into a max-depth
+// pyramid. A box is occluded when its nearest depth is behind the farthest depth of the (at most
+// 2x2) pyramid texels covering it.
+//
+// Texels no reprojected sample lands on (disocclusions, or gaps while moving forward) are at
+// the far plane, they never occlude anything. The scene is assumed static between the readback
+// and its use.
+class OcclusionCuller
+{
+public:
+	struct Statistics
+	{
+		unsigned int m_Tested;
+		unsigned int m_Occluded;
+	};
+
+	OcclusionCuller(const int width, const int height);
+	~OcclusionCuller();
+
+	OcclusionCuller(const OcclusionCuller&) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+	// Queues a readback of the depth buffer of a framebuffer (of the size given on construction),
+	// rendered with the given view-projection matrix. Skipped while every buffer is in flight.
+	void readDepth(const unsigned int framebufferID, const glm::mat4& viewProjectionMatrix);
+
+	// Once per frame, collects the completed readbacks and rebuilds the pyramid for the view.
+	void update(const glm::mat4& viewProjectionMatrix);
+
+	bool isOccluded(const BoundingBox& box, const glm::mat4& modelMatrix = glm::mat4(1.0f));
+	bool isReady() const;
+
+	const Statistics& getStatistics() const; // Of the last complete frame.
+
+	static const int s_Downsampling = 4;
+	static const int s_NumberOfReadbacks = 3;
+
+private:
+	struct Readback
+	{
+		unsigned int m_PBO;
+		GLsync m_Fence; // Null when the buffer is free.
+		glm::mat4 m_ViewProjectionMatrix;
+	};
+
+	int m_Width, m_Height;
+	Readback m_Readbacks[s_NumberOfReadbacks];
+	int m_NextReadback;
+
+	// Reduced depth of the last completed readback, and the matrix it was rendered with.
+	std::vector<float> m_Depth;
+	glm::mat4 m_DepthViewProjectionMatrix;
+	bool m_DepthAvailable;
+
+	std::vector<std::vector<float>> m_Levels; // Max-depth pyramid, in the current view.
+	std::vector<glm::ivec2> m_LevelSizes;
+	glm::mat4 m_ViewProjectionMatrix;
+
+	Statistics m_Statistics, m_LastStatistics;
+
+	void reduceReadback(const float* depth);
+	void reproject();
+	void buildPyramid();
+};
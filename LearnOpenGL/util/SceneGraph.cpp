@@ -0,0 +1,95 @@
+#include "SceneGraph.h"
+
+SceneGraph::SceneGraph()
+	: m_LocalMatrices(), m_WorldMatrices(), m_Parents(), m_Dirty(), m_Names(), m_FirstDirtyNode(0), m_NumberOfUpdatedNodes(0)
+{
+}
+
+unsigned int SceneGraph::addNode(const glm::mat4& localMatrix, const unsigned int parent, const std::string& name)
+{
+	unsigned int node = (unsigned int)m_Parents.size();
+
+	if (parent != s_NoParent && parent >= node)
+	{
+		std::cout << "[ERROR] SCENE GRAPH: Parent " << parent << " of \"" << name << "\" doesn't exist, the node is added as a root." << std::endl;
+	}
+
+	unsigned int validParent = parent < node ? parent : s_NoParent;
+
+	m_LocalMatrices.push_back(localMatrix);
+	m_WorldMatrices.push_back(localMatrix);
+	m_Parents.push_back(validParent);
+	m_Dirty.push_back(1);
+	m_Names.push_back(name);
+
+	m_FirstDirtyNode = std::min(m_FirstDirtyNode, node);
+
+	return node;
+}
+
+void SceneGraph::setLocalMatrix(const unsigned int node, const glm::mat4& localMatrix)
+{
+	m_LocalMatrices[node] = localMatrix;
+	m_Dirty[node] = 1;
+
+	m_FirstDirtyNode = std::min(m_FirstDirtyNode, node);
+}
+
+void SceneGraph::update()
+{
+	unsigned int numberOfNodes = (unsigned int)m_Parents.size();
+
+	m_NumberOfUpdatedNodes = 0;
+
+	// Parents are always visited first, a dirty parent makes its children dirty in turn.
+	for (unsigned int node = m_FirstDirtyNode; node < numberOfNodes; node++)
+	{
+		unsigned int parent = m_Parents[node];
+
+		if (parent != s_NoParent && m_Dirty[parent])
+		{
+			m_Dirty[node] = 1;
+		}
+
+		if (m_Dirty[node])
+		{
+			m_WorldMatrices[node] = parent == s_NoParent ? m_LocalMatrices[node] : m_WorldMatrices[parent] * m_LocalMatrices[node];
+			m_NumberOfUpdatedNodes++;
+		}
+	}
+
+	// Cleared afterwards, children read the flags of their parents during the pass.
+	std::fill(m_Dirty.begin() + std::min(m_FirstDirtyNode, numberOfNodes), m_Dirty.end(), 0);
+
+	m_FirstDirtyNode = numberOfNodes;
+}
+
+const glm::mat4& SceneGraph::getLocalMatrix(const unsigned int node) const
+{
+	return m_LocalMatrices[node];
+}
+
+const glm::mat4& SceneGraph::getWorldMatrix(const unsigned int node) const
+{
+	return m_WorldMatrices[node];
+}
+
+unsigned int SceneGraph::getParent(const unsigned int node) const
+{
+	return m_Parents[node];
+}
+
+const std::string& SceneGraph::getName(const unsigned int node) const
+{
+	return m_Names[node];
+}
+
+size_t SceneGraph::getNumberOfNodes() const
+{
+	return m_Parents.size();
+}
+
+unsigned int SceneGraph::getNumberOfUpdatedNodes() const
+{
+	return m_NumberOfUpdatedNodes;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+// Transform hierarchy of the scene, with the world matrices cached.
+//
+// Nodes live in parallel arrays, and a node can only be added under an existing one, so every
+// parent comes before its children: "update" recomputes the world matrices in a single forward
+// pass. Only the nodes whose local matrix changed, and their descendants, are recomputed, and
+// the pass starts at the first changed node.
+class SceneGraph
+{
+public:
+	SceneGraph();
+
+	unsigned int addNode(const glm::mat4& localMatrix, const unsigned int parent = s_NoParent, const std::string& name = "");
+
+	void setLocalMatrix(const unsigned int node, const glm::mat4& localMatrix);
+	void update();
+
+	const glm::mat4& getLocalMatrix(const unsigned int node) const;
+	const glm::mat4& getWorldMatrix(const unsigned int node) const; // As of the last "update".
+	unsigned int getParent(const unsigned int node) const;
+	const std::string& getName(const unsigned int node) const;
+
+	size_t getNumberOfNodes() const;
+	unsigned int getNumberOfUpdatedNodes() const; // By the last "update".
+
+	static const unsigned int s_NoParent = 0xFFFFFFFF;
+
+private:
+	std::vector<glm::mat4> m_LocalMatrices, m_WorldMatrices;
+	std::vector<unsigned int> m_Parents;
+	std::vector<unsigned char> m_Dirty;
+	std::vector<std::string> m_Names;
+
+	unsigned int m_FirstDirtyNode; // Number of nodes when none is dirty.
+	unsigned int m_NumberOfUpdatedNodes;
+};
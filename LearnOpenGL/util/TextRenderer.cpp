@@ -1,140 +1,350 @@
 #include "TextRenderer.h"
 
-TextRenderer::TextRenderer(const char* filepath)
-	: m_VAO(), m_VBO()
+namespace
 {
-	FT_Library freeTypeLib;
-	FT_Face face;
+	const int c_RasterSize = 32;    // Pixel size glyphs are rasterized at.
+	const int c_ReferenceSize = 48; // Pixel size of the text at scale 1.
+	const int c_Spread = 6;         // Distance (in pixels) covered by the fields around the outlines.
 
-	if (FT_Init_FreeType(&freeTypeLib))
+	const int c_AtlasSize = 1024;
+	const int c_CellSize = 48; // Fits the largest glyphs at the raster size, spread included.
+	const int c_CellsPerRow = c_AtlasSize / c_CellSize;
+
+	const unsigned int c_ReplacementCharacter = 0xFFFD;
+}
+
+TextRenderer::TextRenderer(const char* filepath, StreamBuffer* streamBuffer)
+	: m_FreeTypeLib(), m_Face(), m_ASCIICharacters(), m_Characters(), m_AtlasID(), m_VAO(),
+	  m_Cells(c_CellsPerRow * c_CellsPerRow, { 0, 0, false }), m_Batch(1), m_FullBatch(0), m_AtlasFullReported(false), m_Vertices(), m_StreamBuffer(streamBuffer)
+{
+	// The face stays open, since glyphs are rasterized on demand.
+	if (FT_Init_FreeType(&m_FreeTypeLib))
 	{
 		std::cout << "[ERROR] TEXT RENDERER: Could not init FreeType library." << std::endl;
+
+		m_FreeTypeLib = nullptr;
+	}
+	else if (FT_New_Face(m_FreeTypeLib, filepath, 0, &m_Face))
+	{
+		std::cout << "[ERROR] TEXT RENDERER: Failed to load font." << std::endl;
+
+		m_Face = nullptr;
 	}
 	else
 	{
-		if (FT_New_Face(freeTypeLib, filepath, 0, &face))
+		FT_Int spread = c_Spread;
+
+		// Both SDF rasterizers (from outlines and from bitmaps) share the same spread.
+		FT_Property_Set(m_FreeTypeLib, "sdf", "spread", &spread);
+		FT_Property_Set(m_FreeTypeLib, "bsdf", "spread", &spread);
+
+		FT_Set_Pixel_Sizes(m_Face, 0, c_RasterSize); // Set size to load glyphs as.
+	}
+
+	std::vector<unsigned char> atlas(c_AtlasSize * c_AtlasSize, 0);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Disable byte-alignment restriction.
+
+	glGenTextures(1, &m_AtlasID);
+	GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D, m_AtlasID);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, c_AtlasSize, c_AtlasSize, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	ResourceTracker::track(ResourceTracker::Category::TEXTURE, m_AtlasID, ResourceTracker::getTextureSize(GL_R8, c_AtlasSize, c_AtlasSize));
+
+	glGenVertexArrays(1, &m_VAO);
+
+	ResourceTracker::track(ResourceTracker::Category::VERTEX_ARRAY, m_VAO);
+
+	GLStateCache::bindVertexArray(m_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer->getID());
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Position));
+
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Color));
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+TextRenderer::~TextRenderer()
+{
+	ResourceTracker::untrack(ResourceTracker::Category::TEXTURE, m_AtlasID);
+	ResourceTracker::untrack(ResourceTracker::Category::VERTEX_ARRAY, m_VAO);
+
+	glDeleteTextures(1, &m_AtlasID);
+	glDeleteVertexArrays(1, &m_VAO);
+
+	if (m_Face)
+	{
+		FT_Done_Face(m_Face);
+	}
+
+	if (m_FreeTypeLib)
+	{
+		FT_Done_FreeType(m_FreeTypeLib);
+	}
+}
+
+void TextRenderer::queue(const std::string& text, float x, float y, float scale, const glm::vec3& color)
+{
+	// Glyphs are rasterized at "c_RasterSize", but "scale" is relative to "c_ReferenceSize".
+	scale *= (float)c_ReferenceSize / (float)c_RasterSize;
+
+	for (size_t i = 0; i < text.size(); )
+	{
+		const Character* ch = getCharacter(decodeUTF8(text, i));
+
+		// Glyphs without pixels (e.g. spaces) only advance the cursor.
+		if (ch->m_Cell > -1)
 		{
-			std::cout << "[ERROR] TEXT RENDERER: Failed to load font." << std::endl;
+			float xpos = x + ch->m_Bearing.x * scale;
+			float ypos = y - (ch->m_Size.y - ch->m_Bearing.y) * scale;
+
+			float w = ch->m_Size.x * scale;
+			float h = ch->m_Size.y * scale;
+
+			// The atlas rows are stored top to bottom, like the glyph bitmaps.
+			Vertex topLeft     = { { xpos,     ypos + h }, { ch->m_UVMin.x, ch->m_UVMin.y }, color };
+			Vertex bottomLeft  = { { xpos,     ypos     }, { ch->m_UVMin.x, ch->m_UVMax.y }, color };
+			Vertex bottomRight = { { xpos + w, ypos     }, { ch->m_UVMax.x, ch->m_UVMax.y }, color };
+			Vertex topRight    = { { xpos + w, ypos + h }, { ch->m_UVMax.x, ch->m_UVMin.y }, color };
+
+			m_Vertices.insert(m_Vertices.end(), { topLeft, bottomLeft, bottomRight, topLeft, bottomRight, topRight });
 		}
-		else
-		{
-			FT_Set_Pixel_Sizes(face, 0, 48); // Set size to load glyphs as.
 
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Disable byte-alignment restriction.
+		// Now advance cursors for next glyph (note that advance is number of 1/64 pixels).
+		x += (ch->m_Advance >> 6) * scale;
+	}
+}
+
+void TextRenderer::flush(ShaderProgram& shaderProgram)
+{
+	if (m_Vertices.empty())
+	{
+		return;
+	}
+
+	StreamBuffer::Allocation allocation = m_StreamBuffer->allocate((int)(m_Vertices.size() * sizeof(Vertex)), sizeof(Vertex));
 
-            // Load first 128 characters of ASCII set.
-            for (unsigned char c = 0; c < 128; c++)
-            {
-                unsigned int texId;
+	if (allocation.m_Data)
+	{
+		std::memcpy(allocation.m_Data, m_Vertices.data(), m_Vertices.size() * sizeof(Vertex));
 
-                if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-                {
-                    std::cout << "[ERROR] TEXT RENDERER: Failed to load glyph." << std::endl;
-                    continue;
-                }
+		m_StreamBuffer->flush();
 
-                glGenTextures(1, &texId);
-                glBindTexture(GL_TEXTURE_2D, texId);
+		// The recorded state is restored, querying the driver could stall the pipeline.
+		bool blendIsEnabled = GLStateCache::isEnabled(GL_BLEND);
 
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
+		GLStateCache::setEnabled(GL_BLEND, true);
+		GLStateCache::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		shaderProgram.setSamplerUnit("uText", s_AtlasUnit);
+		shaderProgram.bind();
 
-                Character character = { texId, glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows), glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top), (unsigned int)(face->glyph->advance.x) };
+		GLStateCache::bindTexture(s_AtlasUnit, GL_TEXTURE_2D, m_AtlasID);
+		GLStateCache::bindVertexArray(m_VAO);
 
-                m_Characters.insert(std::pair<char, Character>(c, character));
-            }
+		glDrawArrays(GL_TRIANGLES, allocation.m_Offset / sizeof(Vertex), (int)m_Vertices.size());
 
-            glBindTexture(GL_TEXTURE_2D, 0);
-		}
-		
-		FT_Done_Face(face);
+		GLStateCache::setEnabled(GL_BLEND, blendIsEnabled);
 	}
 
-	FT_Done_FreeType(freeTypeLib);
+	// Glyphs of the next batch may evict the ones of this batch.
+	m_Vertices.clear();
+	m_Batch++;
+}
+
+void TextRenderer::write(ShaderProgram& shaderProgram, std::string text, float x, float y, float scale, glm::vec3 color)
+{
+	queue(text, x, y, scale, color);
+	flush(shaderProgram);
+}
+
+unsigned int TextRenderer::decodeUTF8(const std::string& text, size_t& index)
+{
+	static const unsigned int minimums[] = { 0x0, 0x80, 0x800, 0x10000 };
+
+	unsigned char lead = (unsigned char)text[index++];
+	unsigned int codepoint;
+	int length;
 
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
+	if (lead < 0x80)
+	{
+		return lead;
+	}
+	else if ((lead & 0xE0) == 0xC0)
+	{
+		codepoint = lead & 0x1F;
+		length = 1;
+	}
+	else if ((lead & 0xF0) == 0xE0)
+	{
+		codepoint = lead & 0x0F;
+		length = 2;
+	}
+	else if ((lead & 0xF8) == 0xF0)
+	{
+		codepoint = lead & 0x07;
+		length = 3;
+	}
+	else
+	{
+		return c_ReplacementCharacter;
+	}
 
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+	for (int i = 0; i < length; i++)
+	{
+		// A truncated sequence is replaced, and the byte that interrupted it is decoded next.
+		if (index >= text.size() || ((unsigned char)text[index] & 0xC0) != 0x80)
+		{
+			return c_ReplacementCharacter;
+		}
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+		codepoint = (codepoint << 6) | ((unsigned char)text[index++] & 0x3F);
+	}
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+	// Overlong encodings, surrogates and values past the Unicode range are invalid.
+	if (codepoint < minimums[length] || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+	{
+		return c_ReplacementCharacter;
+	}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+	return codepoint;
 }
 
-TextRenderer::~TextRenderer()
+Character* TextRenderer::getCharacter(unsigned int codepoint)
 {
-	// TODO: Delete all generated textures and buffers.
+	Character& character = codepoint < s_NumberOfASCIICharacters ? m_ASCIICharacters[codepoint] : m_Characters[codepoint];
+
+	// Evicted glyphs keep their metrics, but must be rasterized again. Not while the atlas is full,
+	// it would be for nothing until the batch is flushed.
+	bool evicted = character.m_Loaded && character.m_Cell < 0 && character.m_Size.x > 0 && character.m_Size.y > 0;
+
+	if (!character.m_Loaded || (evicted && m_FullBatch != m_Batch))
+	{
+		loadCharacter(codepoint, character);
+	}
+
+	if (character.m_Cell > -1)
+	{
+		m_Cells[character.m_Cell].m_LastUse = m_Batch;
+	}
+
+	return &character;
 }
 
-void TextRenderer::write(ShaderProgram& shaderProgram, std::string text, float x, float y, float scale, glm::vec3 color)
+void TextRenderer::loadCharacter(unsigned int codepoint, Character& character)
 {
-    bool blendIsEnabled = glIsEnabled(GL_BLEND);
+	character.m_Loaded = true;
+
+	if (!m_Face)
+	{
+		return;
+	}
+
+	if (FT_Load_Glyph(m_Face, FT_Get_Char_Index(m_Face, codepoint), FT_LOAD_DEFAULT) || FT_Render_Glyph(m_Face->glyph, FT_RENDER_MODE_SDF))
+	{
+		std::cout << "[ERROR] TEXT RENDERER: Failed to load glyph " << codepoint << "." << std::endl;
+
+		return;
+	}
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	const FT_Bitmap& bitmap = m_Face->glyph->bitmap;
 
-    shaderProgram.bind();
+	// Larger glyphs are cropped to the cell.
+	character.m_Size = glm::ivec2(std::min((int)bitmap.width, c_CellSize), std::min((int)bitmap.rows, c_CellSize));
+	character.m_Bearing = glm::ivec2(m_Face->glyph->bitmap_left, m_Face->glyph->bitmap_top);
+	character.m_Advance = (unsigned int)m_Face->glyph->advance.x;
 
-    shaderProgram.setUniform3f("uTextColor", color);
+	if (character.m_Size.x == 0 || character.m_Size.y == 0)
+	{
+		return;
+	}
+
+	character.m_Cell = acquireCell(codepoint);
+
+	if (character.m_Cell < 0)
+	{
+		return;
+	}
+
+	// The whole cell is uploaded, so nothing of the evicted glyph remains.
+	std::vector<unsigned char> cell(c_CellSize * c_CellSize, 0);
+
+	for (int row = 0; row < character.m_Size.y; row++)
+	{
+		std::memcpy(cell.data() + row * c_CellSize, bitmap.buffer + row * bitmap.pitch, character.m_Size.x);
+	}
+
+	const int cellX = (character.m_Cell % c_CellsPerRow) * c_CellSize;
+	const int cellY = (character.m_Cell / c_CellsPerRow) * c_CellSize;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    glBindVertexArray(m_VAO);
-    glActiveTexture(GL_TEXTURE0 + 15);
+	GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D, m_AtlasID);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, cellX, cellY, c_CellSize, c_CellSize, GL_RED, GL_UNSIGNED_BYTE, cell.data());
 
-    std::string::const_iterator ci;
+	character.m_UVMin = glm::vec2((float)cellX / c_AtlasSize, (float)cellY / c_AtlasSize);
+	character.m_UVMax = glm::vec2((float)(cellX + character.m_Size.x) / c_AtlasSize, (float)(cellY + character.m_Size.y) / c_AtlasSize);
+}
 
-    for (ci = text.begin(); ci != text.end(); ci++)
-    {
-        Character ch = m_Characters[*ci];
+int TextRenderer::acquireCell(unsigned int codepoint)
+{
+	int leastRecentlyUsed = -1;
 
-        float xpos = x + ch.m_Bearing.x * scale;
-        float ypos = y - (ch.m_Size.y - ch.m_Bearing.y) * scale;
+	for (int i = 0; i < (int)m_Cells.size(); i++)
+	{
+		if (!m_Cells[i].m_Used)
+		{
+			leastRecentlyUsed = i;
+			break;
+		}
 
-        float w = ch.m_Size.x * scale;
-        float h = ch.m_Size.y * scale;
+		// Glyphs of the pending batch are still referenced by its quads.
+		if (m_Cells[i].m_LastUse != m_Batch && (leastRecentlyUsed < 0 || m_Cells[i].m_LastUse < m_Cells[leastRecentlyUsed].m_LastUse))
+		{
+			leastRecentlyUsed = i;
+		}
+	}
 
-        // Update VBO for each character.
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
+	if (leastRecentlyUsed < 0)
+	{
+		m_FullBatch = m_Batch;
 
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
-        };
+		if (!m_AtlasFullReported)
+		{
+			std::cout << "[ERROR] TEXT RENDERER: Glyph atlas is full, flush the text more often." << std::endl;
 
-        // Render glyph texture over quad.
-        glBindTexture(GL_TEXTURE_2D, ch.m_TexID);
+			m_AtlasFullReported = true;
+		}
 
-        // Update content of VBO memory.
-        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // Be sure to use glBufferSubData and not glBufferData.
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return -1;
+	}
 
-        // Draw quad.
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+	AtlasCell& cell = m_Cells[leastRecentlyUsed];
 
-        // Now advance cursors for next glyph (note that advance is number of 1/64 pixels).
-        x += (ch.m_Advance >> 6) * scale;
-    }
+	if (cell.m_Used)
+	{
+		unsigned int evicted = cell.m_Codepoint;
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindVertexArray(0);
+		if (evicted < s_NumberOfASCIICharacters)
+		{
+			m_ASCIICharacters[evicted].m_Cell = -1;
+		}
+		else
+		{
+			m_Characters[evicted].m_Cell = -1;
+		}
+	}
 
-    shaderProgram.unbind();
+	cell = { codepoint, m_Batch, true };
 
-    if (!blendIsEnabled)
-    {
-        glDisable(GL_BLEND);
-    }
-}
\ No newline at end of file
+	return leastRecentlyUsed;
+}
@@ -1,8 +1,12 @@
 #pragma once
 
-#include <map>
 #include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
 #include <iostream>
+#include <algorithm>
+#include <unordered_map>
 
 #include <glad/glad.h>
 
@@ -15,27 +19,84 @@
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_MODULE_H
 #endif // _FREETYPE_INCLUDED
 
 #include "../core/ShaderProgram.h"
+#include "../core/StreamBuffer.h"
+#include "../core/ResourceTracker.h"
+#include "../core/GLStateCache.h"
 
 struct Character
 {
-	unsigned int m_TexID;
+	glm::vec2 m_UVMin, m_UVMax; // Rectangle of the glyph in the atlas.
 
 	glm::ivec2 m_Size, m_Bearing;
 	unsigned int m_Advance;
+
+	bool m_Loaded = false; // Metrics are known.
+	int m_Cell = -1; // Atlas cell holding the glyph, -1 when it isn't resident.
 };
 
+// Renders UTF-8 text with signed distance field glyphs, so one atlas at one resolution
+// serves every on-screen size.
+//
+// Glyphs are rasterized on demand into the cells of a fixed-size atlas. When it's full, the
+// least recently used glyph is evicted (never one drawn by the pending batch). ASCII glyphs
+// are looked up in a flat array, the others in a hash map keyed by codepoint.
+//
+// Text is queued (with its own color) and every queued quad is drawn by "flush" with a single
+// draw call, so a whole frame's worth of text costs one upload and one draw.
 class TextRenderer
 {
 public:
-	TextRenderer(const char* filepath);
+	TextRenderer(const char* filepath, StreamBuffer* streamBuffer);
 	~TextRenderer();
 
+	TextRenderer(const TextRenderer&) = delete;
+	TextRenderer& operator=(const TextRenderer&) = delete;
+
+	void queue(const std::string& text, float x, float y, float scale, const glm::vec3& color);
+	void flush(ShaderProgram& shaderProgram);
+
 	void write(ShaderProgram& shaderProgram, std::string text, float x, float y, float scale, glm::vec3 color);
 
+	static unsigned int decodeUTF8(const std::string& text, size_t& index);
+
 private:
-	std::map<GLchar, Character> m_Characters;
-	unsigned int m_VAO, m_VBO;
-};
\ No newline at end of file
+	struct Vertex
+	{
+		glm::vec2 m_Position;
+		glm::vec2 m_TexCoords;
+		glm::vec3 m_Color;
+	};
+
+	struct AtlasCell
+	{
+		unsigned int m_Codepoint;
+		unsigned int m_LastUse; // Batch in which the glyph was last queued.
+		bool m_Used;
+	};
+
+	static const int s_NumberOfASCIICharacters = 128;
+	static const int s_AtlasUnit = 15;
+
+	FT_Library m_FreeTypeLib;
+	FT_Face m_Face;
+
+	Character m_ASCIICharacters[s_NumberOfASCIICharacters];
+	std::unordered_map<unsigned int, Character> m_Characters;
+
+	unsigned int m_AtlasID, m_VAO;
+	std::vector<AtlasCell> m_Cells;
+	unsigned int m_Batch;
+	unsigned int m_FullBatch; // Last batch that ran out of cells, none frees up before the next one.
+	bool m_AtlasFullReported;
+
+	std::vector<Vertex> m_Vertices; // Queued since the last flush.
+	StreamBuffer* m_StreamBuffer;
+
+	Character* getCharacter(unsigned int codepoint);
+	void loadCharacter(unsigned int codepoint, Character& character);
+	int acquireCell(unsigned int codepoint);
+};
@@ -1,90 +1,79 @@
 #include "Texture.h"
 
 Texture::Texture(const char* filepath, const bool gammaCorrection)
-	: m_ID(), m_Width(), m_Height(), m_ColorChannels()
+	: Texture(nullptr, filepath, gammaCorrection)
 {
-	stbi_set_flip_vertically_on_load(true);
-
-	unsigned char* data = stbi_load(filepath, &m_Width, &m_Height, &m_ColorChannels, 0);
-	int internalFormat = GL_RED, format = GL_RED; // Default format.
+}
 
-	// WARNING: We are only expecting an image with 3 or 4 color channels.
-	//			Any other format may generate some OpenGL error.
+Texture::Texture(TextureManager* textureManager, const char* filepath, const bool gammaCorrection)
+	: m_ID(), m_Width(), m_Height(), m_ColorChannels(), m_Cached(true), m_Unit(-1)
+{
+	// Without a manager, the image is loaded right away. Otherwise a placeholder is sampled
+	// until the manager uploads it.
+	m_ID = TextureCache::load(filepath, gammaCorrection, true, textureManager);
+}
 
+Texture::Texture(int width, int height, int internalFormat, int format, int type, const float* data)
+	: m_ID(), m_Width(width), m_Height(height), m_ColorChannels(), m_Cached(false), m_Unit(-1)
+{
 	glGenTextures(1, &m_ID);
-	glBindTexture(GL_TEXTURE_2D, m_ID);
-
-	switch (m_ColorChannels)
-	{
-	case 3:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		internalFormat = gammaCorrection ? GL_SRGB : GL_RGB;
-		format = GL_RGB;
-
-		break;
+	GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D, m_ID);
 
-	case 4:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-		internalFormat = gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
-		format = GL_RGBA;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-		break;
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data);
 
-	default:
-		std::cout << "[ERROR] TEXTURE: Texture format not supported." << std::endl;
+	ResourceTracker::track(ResourceTracker::Category::TEXTURE, m_ID, ResourceTracker::getTextureSize(internalFormat, width, height));
+}
 
-		break;
+Texture::~Texture()
+{
+	if (m_ID == 0)
+	{
+		return;
 	}
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	if (data)
+	if (m_Cached)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_Width, m_Height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		TextureCache::release(m_ID);
 	}
 	else
 	{
-		std::cout << "[ERROR] TEXTURE: Failed to load texture in \"" << filepath << "\"." << std::endl;
-	}
-
-	glBindTexture(GL_TEXTURE_2D, 0);
+		ResourceTracker::untrack(ResourceTracker::Category::TEXTURE, m_ID);
 
-	stbi_image_free(data);
+		glDeleteTextures(1, &m_ID);
+	}
 }
 
-Texture::Texture(int width, int height, int internalFormat, int format, int type, const float* data)
-	: m_ID(), m_Width(width), m_Height(height), m_ColorChannels()
+Texture::Texture(Texture&& other) noexcept
+	: m_ID(other.m_ID), m_Width(other.m_Width), m_Height(other.m_Height), m_ColorChannels(other.m_ColorChannels), m_Cached(other.m_Cached), m_Unit(other.m_Unit)
 {
-	glGenTextures(1, &m_ID);
-	glBindTexture(GL_TEXTURE_2D, m_ID);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
+	other.m_ID = 0;
 }
 
-Texture::~Texture()
+Texture& Texture::operator=(Texture&& other) noexcept
 {
-	glDeleteTextures(1, &m_ID);
+	// The previous texture is released along with "other".
+	std::swap(m_ID, other.m_ID);
+	std::swap(m_Width, other.m_Width);
+	std::swap(m_Height, other.m_Height);
+	std::swap(m_ColorChannels, other.m_ColorChannels);
+	std::swap(m_Cached, other.m_Cached);
+	std::swap(m_Unit, other.m_Unit);
+
+	return *this;
 }
 
 void Texture::bind(int unit)
 {
 	if (unit >= 0 && unit <= 15)
 	{
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(GL_TEXTURE_2D, m_ID);
+		GLStateCache::bindTexture(unit, GL_TEXTURE_2D, m_ID);
+
+		m_Unit = unit;
 	}
 	else
 	{
@@ -94,5 +83,10 @@ void Texture::bind(int unit)
 
 void Texture::unbind()
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
+	if (m_Unit >= 0)
+	{
+		GLStateCache::bindTexture(m_Unit, GL_TEXTURE_2D, 0);
+
+		m_Unit = -1;
+	}
 }
\ No newline at end of file
@@ -4,23 +4,30 @@
 
 #include <glad/glad.h>
 
-#if !defined _STB_IMAGE_INCLUDED
-#define _STB_IMAGE_INCLUDED
-
-#include <stb/stb_image.h>
-#endif // _STB_IMAGE_INCLUDED
+#include "TextureCache.h"
+#include "../core/ResourceTracker.h"
+#include "../core/GLStateCache.h"
 
 class Texture
 {
 public:
 	Texture(const char* filepath, const bool gammaCorrection = false);
+	Texture(TextureManager* textureManager, const char* filepath, const bool gammaCorrection = false);
 	Texture(int width, int height, int internalFormat, int format, int type, const float* data);
 	~Texture();
 
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
 	void bind(int unit);
 	void unbind();
 
 private:
 	unsigned int m_ID;
-	int m_Width, m_Height, m_ColorChannels;
+	int m_Width, m_Height, m_ColorChannels; // Only known for textures created from memory.
+	bool m_Cached; // Loaded from a file, shared through the texture cache.
+	int m_Unit; // Last unit it was bound to, if any.
 };
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "TextureCache.h"
+
+std::unordered_map<std::string, unsigned int> TextureCache::s_TextureIDs;
+std::unordered_map<unsigned int, TextureCache::Entry> TextureCache::s_Entries;
+
+unsigned int TextureCache::load(const std::string& filepath, const bool gammaCorrection, const bool flip, TextureManager* textureManager, const glm::vec4& placeholder)
+{
+	std::string key = getKey(filepath, gammaCorrection, flip);
+	unsigned int textureID = acquire(key);
+
+	if (textureID)
+	{
+		return textureID;
+	}
+
+	// Precompressed textures skip both the image decode and the mipmap generation.
+	textureID = TextureContainer::load(filepath, gammaCorrection, flip);
+
+	if (!textureID && textureManager)
+	{
+		textureID = textureManager->load(filepath, gammaCorrection, flip, placeholder);
+	}
+	else if (!textureID)
+	{
+		textureID = TextureManager::createTexture(TextureManager::decode(filepath, flip), gammaCorrection, filepath);
+	}
+
+	// Failures aren't cached, the next load tries again.
+	if (textureID)
+	{
+		insert(key, textureID, textureManager);
+	}
+
+	return textureID;
+}
+
+unsigned int TextureCache::loadCubeMap(const std::array<std::string, 6>& filepaths, TextureManager* textureManager)
+{
+	std::string key = "cube";
+
+	for (const std::string& filepath : filepaths)
+	{
+		key += "|" + canonicalize(filepath);
+	}
+
+	unsigned int textureID = acquire(key);
+
+	if (textureID)
+	{
+		return textureID;
+	}
+
+	if (textureManager)
+	{
+		textureID = textureManager->loadCubeMap(filepaths);
+	}
+	else
+	{
+		textureID = TextureManager::createCubeMap(filepaths);
+	}
+
+	if (textureID)
+	{
+		insert(key, textureID, textureManager);
+	}
+
+	return textureID;
+}
+
+unsigned int TextureCache::acquire(const std::string& key)
+{
+	auto it = s_TextureIDs.find(key);
+
+	if (it == s_TextureIDs.end())
+	{
+		return 0;
+	}
+
+	s_Entries[it->second].m_References++;
+
+	return it->second;
+}
+
+void TextureCache::insert(const std::string& key, const unsigned int textureID, TextureManager* textureManager)
+{
+	s_TextureIDs[key] = textureID;
+	s_Entries[textureID] = { key, 1, textureManager };
+}
+
+void TextureCache::release(const unsigned int textureID)
+{
+	auto it = s_Entries.find(textureID);
+
+	if (it == s_Entries.end())
+	{
+		std::cout << "[ERROR] TEXTURE CACHE: Texture " << textureID << " isn't cached." << std::endl;
+
+		return;
+	}
+
+	if (--it->second.m_References > 0)
+	{
+		return;
+	}
+
+	if (it->second.m_TextureManager)
+	{
+		it->second.m_TextureManager->release(textureID);
+	}
+	else
+	{
+		ResourceTracker::untrack(ResourceTracker::Category::TEXTURE, textureID);
+
+		glDeleteTextures(1, &textureID);
+	}
+
+	s_TextureIDs.erase(it->second.m_Key);
+	s_Entries.erase(it);
+}
+
+std::string TextureCache::getKey(const std::string& filepath, const bool gammaCorrection, const bool flip)
+{
+	return canonicalize(filepath) + (gammaCorrection ? "|srgb" : "|linear") + (flip ? "|flip" : "");
+}
+
+size_t TextureCache::getNumberOfTextures()
+{
+	return s_Entries.size();
+}
+
+std::string TextureCache::canonicalize(const std::string& filepath)
+{
+	std::error_code error;
+
+	// "models/a/../b.png" and "models/b.png" are the same image.
+	std::filesystem::path path = std::filesystem::weakly_canonical(filepath, error);
+
+	if (error)
+	{
+		path = std::filesystem::absolute(filepath, error).lexically_normal();
+	}
+
+	return path.generic_string();
+}
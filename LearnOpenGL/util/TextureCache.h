@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "TextureManager.h"
+#include "TextureContainer.h"
+
+// Process-wide cache of the textures loaded from files, shared by "Texture", "CubeMap" and "Model".
+//
+// Entries are keyed by the canonical filepath and the load parameters, so the same image loaded
+// with another gamma correction or orientation is a distinct texture. They are reference counted:
+// every "load" or successful "acquire" must be paired with a "release", the last one deletes
+// the texture. Like every GL object, it's only meant to be used from the render thread.
+class TextureCache
+{
+public:
+	static unsigned int load(const std::string& filepath, const bool gammaCorrection, const bool flip, TextureManager* textureManager = nullptr, const glm::vec4& placeholder = glm::vec4(1.0f));
+	static unsigned int loadCubeMap(const std::array<std::string, 6>& filepaths, TextureManager* textureManager = nullptr);
+
+	static unsigned int acquire(const std::string& key);
+	static void insert(const std::string& key, const unsigned int textureID, TextureManager* textureManager);
+	static void release(const unsigned int textureID);
+
+	static std::string getKey(const std::string& filepath, const bool gammaCorrection, const bool flip);
+	static size_t getNumberOfTextures();
+
+private:
+	struct Entry
+	{
+		std::string m_Key;
+		unsigned int m_References;
+		TextureManager* m_TextureManager; // Cancels the upload if the texture is still streaming in.
+	};
+
+	static std::unordered_map<std::string, unsigned int> s_TextureIDs;
+	static std::unordered_map<unsigned int, Entry> s_Entries;
+
+	static std::string canonicalize(const std::string& filepath);
+};
@@ -0,0 +1,461 @@
+#include "TextureCompressor.h"
+
+namespace
+{
+	float toLinear(unsigned char value)
+	{
+		float c = value / 255.0f;
+
+		return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+
+	unsigned char toSRGB(float value)
+	{
+		float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+
+		return (unsigned char)(glm::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	unsigned char toUnorm(float value)
+	{
+		return (unsigned char)(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	unsigned short packRGB565(const glm::vec3& color)
+	{
+		int r = (int)(glm::clamp(color.r, 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+		int g = (int)(glm::clamp(color.g, 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+		int b = (int)(glm::clamp(color.b, 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+
+		return (unsigned short)((r << 11) | (g << 5) | b);
+	}
+
+	glm::vec3 unpackRGB565(unsigned short color)
+	{
+		int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+
+		return glm::vec3((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+	}
+
+	// BC1 color block: the endpoints span the principal axis of the 16 colors.
+	void encodeColorBlock(const unsigned char pixels[16][4], unsigned char* output)
+	{
+		glm::vec3 colors[16], mean(0.0f);
+
+		for (int i = 0; i < 16; i++)
+		{
+			colors[i] = glm::vec3(pixels[i][0], pixels[i][1], pixels[i][2]);
+			mean += colors[i] / 16.0f;
+		}
+
+		glm::mat3 covariance(0.0f);
+
+		for (int i = 0; i < 16; i++)
+		{
+			glm::vec3 d = colors[i] - mean;
+
+			covariance += glm::outerProduct(d, d);
+		}
+
+		// Power iteration, a few steps are enough to converge on 4x4 blocks.
+		glm::vec3 axis(1.0f, 1.0f, 1.0f);
+
+		for (int i = 0; i < 8; i++)
+		{
+			glm::vec3 next = covariance * axis;
+			float length = glm::length(next);
+
+			if (length < 1e-6f)
+			{
+				break;
+			}
+
+			axis = next / length;
+		}
+
+		axis = glm::normalize(axis);
+
+		float minT = 0.0f, maxT = 0.0f;
+
+		for (int i = 0; i < 16; i++)
+		{
+			float t = glm::dot(colors[i] - mean, axis);
+
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		unsigned short color0 = packRGB565(mean + axis * maxT);
+		unsigned short color1 = packRGB565(mean + axis * minT);
+
+		// "color0 > color1" selects the four color mode (no transparent texel).
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		glm::vec3 palette[4] = { unpackRGB565(color0), unpackRGB565(color1) };
+
+		palette[2] = (2.0f * palette[0] + palette[1]) / 3.0f;
+		palette[3] = (palette[0] + 2.0f * palette[1]) / 3.0f;
+
+		unsigned int indices = 0;
+
+		for (int i = 0; color0 != color1 && i < 16; i++)
+		{
+			unsigned int best = 0;
+			float bestDistance = FLT_MAX;
+
+			for (unsigned int j = 0; j < 4; j++)
+			{
+				glm::vec3 d = colors[i] - palette[j];
+				float distance = glm::dot(d, d);
+
+				if (distance < bestDistance)
+				{
+					best = j;
+					bestDistance = distance;
+				}
+			}
+
+			indices |= best << (2 * i);
+		}
+
+		output[0] = color0 & 0xFF;
+		output[1] = color0 >> 8;
+		output[2] = color1 & 0xFF;
+		output[3] = color1 >> 8;
+
+		for (int i = 0; i < 4; i++)
+		{
+			output[4 + i] = (indices >> (8 * i)) & 0xFF;
+		}
+	}
+
+	// BC4 block, a single channel: the alpha of BC3 and each of the two channels of BC5.
+	void encodeChannelBlock(const unsigned char pixels[16][4], int channel, unsigned char* output)
+	{
+		int minValue = 255, maxValue = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			minValue = std::min(minValue, (int)pixels[i][channel]);
+			maxValue = std::max(maxValue, (int)pixels[i][channel]);
+		}
+
+		// "value0 > value1" selects the eight value mode.
+		int palette[8] = { maxValue, minValue };
+
+		for (int i = 1; i < 7; i++)
+		{
+			palette[i + 1] = ((7 - i) * maxValue + i * minValue + 3) / 7;
+		}
+
+		unsigned long long indices = 0;
+
+		for (int i = 0; maxValue != minValue && i < 16; i++)
+		{
+			unsigned long long best = 0;
+			int bestDistance = INT_MAX;
+
+			for (int j = 0; j < 8; j++)
+			{
+				int distance = std::abs(pixels[i][channel] - palette[j]);
+
+				if (distance < bestDistance)
+				{
+					best = j;
+					bestDistance = distance;
+				}
+			}
+
+			indices |= best << (3 * i);
+		}
+
+		output[0] = (unsigned char)maxValue;
+		output[1] = (unsigned char)minValue;
+
+		for (int i = 0; i < 6; i++)
+		{
+			output[2 + i] = (indices >> (8 * i)) & 0xFF;
+		}
+	}
+
+	bool isImage(const std::filesystem::path& filepath)
+	{
+		std::string extension = filepath.extension().string();
+
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+		return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+	}
+
+	bool endsWith(const std::string& text, const std::string& suffix)
+	{
+		return text.size() > suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	// Named "<name>_normal.<extension>" or "<name>_normal_map.<extension>", see the usage line.
+	bool isNormalMap(const std::string& filepath)
+	{
+		std::string stem = std::filesystem::path(filepath).stem().string();
+
+		std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+		return endsWith(stem, "_normal") || endsWith(stem, "_normal_map");
+	}
+
+	const char* getFormatName(TextureContainer::Format format)
+	{
+		switch (format)
+		{
+		case TextureContainer::Format::BC1: return "BC1";
+		case TextureContainer::Format::BC3: return "BC3";
+		case TextureContainer::Format::BC5: return "BC5";
+		default: return "RGBA8";
+		}
+	}
+}
+
+bool TextureCompressor::convert(const std::string& filepath, const TextureContainer::Format* format, const bool srgb)
+{
+	// 2D textures are loaded flipped at runtime, so is the container.
+	stbi_set_flip_vertically_on_load_thread(true);
+
+	int width, height, colorChannels;
+	std::unique_ptr<unsigned char, void(*)(void*)> data(stbi_load(filepath.c_str(), &width, &height, &colorChannels, 4), stbi_image_free);
+
+	if (!data)
+	{
+		std::cout << "[ERROR] TEXTURE COMPRESSOR: Failed to load texture in \"" << filepath << "\"." << std::endl;
+
+		return false;
+	}
+
+	// An explicit format wins over the name, forcing BC5 also treats the image as a normal map.
+	const bool normalMap = format ? *format == TextureContainer::Format::BC5 : isNormalMap(filepath);
+	TextureContainer::Format containerFormat = TextureContainer::Format::BC1;
+
+	if (format)
+	{
+		containerFormat = *format;
+	}
+	else if (normalMap)
+	{
+		containerFormat = TextureContainer::Format::BC5;
+	}
+	else
+	{
+		for (int i = 0; i < width * height; i++)
+		{
+			if (data.get()[i * 4 + 3] != 255)
+			{
+				containerFormat = TextureContainer::Format::BC3;
+
+				break;
+			}
+		}
+	}
+
+	const bool linearFiltering = srgb && !normalMap;
+	std::vector<TextureContainer::Level> levels = generateMipChain(data.get(), width, height, linearFiltering, normalMap);
+
+	for (TextureContainer::Level& level : levels)
+	{
+		level.m_Data = compress(level, containerFormat);
+	}
+
+	if (!TextureContainer::store(filepath, containerFormat, colorChannels, true, linearFiltering, levels))
+	{
+		return false;
+	}
+
+	std::cout << "[INFO] TEXTURE COMPRESSOR: \"" << filepath << "\" -> " << getFormatName(containerFormat) << ", " << levels.size() << " levels." << std::endl;
+
+	return true;
+}
+
+int TextureCompressor::run(int argc, char** argv)
+{
+	std::vector<std::string> filepaths;
+	TextureContainer::Format format = TextureContainer::Format::BC1;
+	bool forceFormat = false, srgb = false;
+
+	for (int i = 0; i < argc; i++)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--srgb")
+		{
+			srgb = true;
+		}
+		else if (argument == "--format" && i + 1 < argc)
+		{
+			std::string name = argv[++i];
+
+			forceFormat = true;
+
+			if (name == "bc1") format = TextureContainer::Format::BC1;
+			else if (name == "bc3") format = TextureContainer::Format::BC3;
+			else if (name == "bc5") format = TextureContainer::Format::BC5;
+			else if (name == "rgba8") format = TextureContainer::Format::RGBA8;
+			else
+			{
+				std::cout << "[ERROR] TEXTURE COMPRESSOR: Unknown format \"" << name << "\"." << std::endl;
+
+				return 1;
+			}
+		}
+		else if (std::filesystem::is_directory(argument))
+		{
+			std::error_code error;
+
+			for (const auto& entry : std::filesystem::recursive_directory_iterator(argument, error))
+			{
+				if (entry.is_regular_file() && isImage(entry.path()))
+				{
+					filepaths.push_back(entry.path().generic_string());
+				}
+			}
+		}
+		else
+		{
+			filepaths.push_back(argument);
+		}
+	}
+
+	if (filepaths.empty())
+	{
+		std::cout << "Usage: LearnOpenGL --compress-textures <image or directory>... [--format bc1|bc3|bc5|rgba8] [--srgb]" << std::endl;
+		std::cout << "Without \"--format\", images named \"*_normal.*\" or \"*_normal_map.*\" are normal maps (BC5), images with alpha use BC3 and the rest BC1." << std::endl;
+
+		return 1;
+	}
+
+	// Images are independent, they are converted in parallel.
+	std::vector<std::future<bool>> tasks;
+	int failures = 0;
+
+	for (const std::string& filepath : filepaths)
+	{
+		tasks.push_back(ThreadPool::getShared().submit([=]() { return convert(filepath, forceFormat ? &format : nullptr, srgb); }));
+	}
+
+	for (std::future<bool>& task : tasks)
+	{
+		failures += task.get() ? 0 : 1;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
+
+std::vector<TextureContainer::Level> TextureCompressor::generateMipChain(const unsigned char* data, const int width, const int height, const bool srgb, const bool normalMap)
+{
+	std::vector<TextureContainer::Level> levels;
+
+	levels.push_back({ width, height, std::vector<unsigned char>(data, data + (size_t)width * height * 4) });
+
+	while (levels.back().m_Width > 1 || levels.back().m_Height > 1)
+	{
+		const TextureContainer::Level& source = levels.back();
+		TextureContainer::Level level = { std::max(source.m_Width / 2, 1), std::max(source.m_Height / 2, 1), {} };
+
+		level.m_Data.resize((size_t)level.m_Width * level.m_Height * 4);
+
+		// 2x2 box filter, odd sizes clamp the last row and column.
+		for (int y = 0; y < level.m_Height; y++)
+		{
+			for (int x = 0; x < level.m_Width; x++)
+			{
+				glm::vec4 sum(0.0f);
+
+				for (int i = 0; i < 4; i++)
+				{
+					int sx = std::min(x * 2 + (i & 1), source.m_Width - 1);
+					int sy = std::min(y * 2 + (i >> 1), source.m_Height - 1);
+					const unsigned char* texel = &source.m_Data[((size_t)sy * source.m_Width + sx) * 4];
+
+					if (srgb)
+					{
+						sum += glm::vec4(toLinear(texel[0]), toLinear(texel[1]), toLinear(texel[2]), texel[3] / 255.0f);
+					}
+					else
+					{
+						sum += glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.0f;
+					}
+				}
+
+				glm::vec4 texel = sum / 4.0f;
+				unsigned char* output = &level.m_Data[((size_t)y * level.m_Width + x) * 4];
+
+				if (normalMap)
+				{
+					// Averaged normals are shorter than one, they're renormalized.
+					glm::vec3 normal = glm::vec3(texel) * 2.0f - 1.0f;
+
+					normal = glm::dot(normal, normal) > 1e-8f ? glm::normalize(normal) : glm::vec3(0.0f, 0.0f, 1.0f);
+					texel = glm::vec4(normal * 0.5f + 0.5f, texel.a);
+				}
+
+				for (int i = 0; i < 4; i++)
+				{
+					output[i] = srgb && i < 3 ? toSRGB(texel[i]) : toUnorm(texel[i]);
+				}
+			}
+		}
+
+		levels.push_back(std::move(level));
+	}
+
+	return levels;
+}
+
+std::vector<unsigned char> TextureCompressor::compress(const TextureContainer::Level& level, const TextureContainer::Format format)
+{
+	if (format == TextureContainer::Format::RGBA8)
+	{
+		return level.m_Data;
+	}
+
+	const int blockSize = format == TextureContainer::Format::BC1 ? 8 : 16;
+	const int blocksWide = (level.m_Width + 3) / 4, blocksHigh = (level.m_Height + 3) / 4;
+
+	std::vector<unsigned char> output((size_t)blocksWide * blocksHigh * blockSize);
+
+	for (int by = 0; by < blocksHigh; by++)
+	{
+		for (int bx = 0; bx < blocksWide; bx++)
+		{
+			unsigned char pixels[16][4];
+			unsigned char* block = &output[((size_t)by * blocksWide + bx) * blockSize];
+
+			// Partial blocks on the edges repeat the last row and column.
+			for (int i = 0; i < 16; i++)
+			{
+				int x = std::min(bx * 4 + (i & 3), level.m_Width - 1);
+				int y = std::min(by * 4 + (i >> 2), level.m_Height - 1);
+
+				memcpy(pixels[i], &level.m_Data[((size_t)y * level.m_Width + x) * 4], 4);
+			}
+
+			switch (format)
+			{
+			case TextureContainer::Format::BC1:
+				encodeColorBlock(pixels, block);
+				break;
+
+			case TextureContainer::Format::BC3:
+				encodeChannelBlock(pixels, 3, block);
+				encodeColorBlock(pixels, block + 8);
+				break;
+
+			default: // BC5, the X and Y of the normal.
+				encodeChannelBlock(pixels, 0, block);
+				encodeChannelBlock(pixels, 1, block + 8);
+				break;
+			}
+		}
+	}
+
+	return output;
+}
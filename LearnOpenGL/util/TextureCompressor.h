@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cmath>
+#include <cctype>
+#include <cfloat>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <future>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+
+#include "ThreadPool.h"
+#include "TextureManager.h"
+#include "TextureContainer.h"
+
+// Offline conversion of images into texture containers (see "TextureContainer").
+//
+// The mip chain is built on the CPU (gamma-correct for sRGB images, renormalized for normal
+// maps) and every level is block-compressed. Run from the command line with:
+//
+//	LearnOpenGL --compress-textures <image or directory>... [--format bc1|bc3|bc5|rgba8] [--srgb]
+//
+// Without "--format", normal maps (named "<name>_normal" or "<name>_normal_map") use BC5,
+// images with alpha BC3 and the rest BC1. "--format bc5" treats every image as a normal map.
+class TextureCompressor
+{
+public:
+	static bool convert(const std::string& filepath, const TextureContainer::Format* format, const bool srgb);
+	static int run(int argc, char** argv);
+
+	static std::vector<TextureContainer::Level> generateMipChain(const unsigned char* data, const int width, const int height, const bool srgb, const bool normalMap);
+	static std::vector<unsigned char> compress(const TextureContainer::Level& level, const TextureContainer::Format format);
+};
@@ -0,0 +1,255 @@
+#include "TextureContainer.h"
+
+namespace
+{
+	const unsigned int c_Magic = 0x54474F4C; // "LOGT".
+	const unsigned int c_Version = 2;
+	const unsigned int c_MaxLevels = 16;
+
+	struct ContainerHeader
+	{
+		unsigned int m_Magic;
+		unsigned int m_Version;
+		unsigned int m_Format;
+		unsigned int m_ColorChannels; // Of the source image, it selects the wrapping mode.
+		unsigned int m_Flipped;
+		unsigned int m_SRGB; // The levels were filtered in linear space, to be sampled as sRGB.
+		unsigned int m_NumberOfLevels;
+		unsigned long long m_SourceSize;
+		long long m_SourceTime;
+	};
+
+	struct LevelRecord
+	{
+		unsigned int m_Width;
+		unsigned int m_Height;
+		unsigned long long m_Offset;
+		unsigned long long m_Size;
+	};
+
+	bool getSourceStamp(const std::string& sourceFilepath, unsigned long long& size, long long& time)
+	{
+		std::error_code error;
+
+		size = std::filesystem::file_size(sourceFilepath, error);
+
+		if (error)
+		{
+			return false;
+		}
+
+		time = (long long)std::filesystem::last_write_time(sourceFilepath, error).time_since_epoch().count();
+
+		return !error;
+	}
+
+	int getInternalFormat(const TextureContainer::Format format, const bool gammaCorrection)
+	{
+		switch (format)
+		{
+		case TextureContainer::Format::BC1:
+			return gammaCorrection ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+		case TextureContainer::Format::BC3:
+			return gammaCorrection ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+		case TextureContainer::Format::BC5:
+			return GL_COMPRESSED_RG_RGTC2; // Normal maps are never gamma corrected.
+
+		default:
+			return gammaCorrection ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+		}
+	}
+}
+
+unsigned int TextureContainer::load(const std::string& sourceFilepath, const bool gammaCorrection, const bool flip)
+{
+	const std::string filepath = getFilepath(sourceFilepath);
+	std::error_code error;
+
+	if (!std::filesystem::exists(filepath, error))
+	{
+		return 0;
+	}
+
+	MappedFile file(filepath);
+	const unsigned char* data = file.getData();
+	const size_t size = file.getSize();
+
+	if (!file.isOpen() || size < sizeof(ContainerHeader))
+	{
+		return 0;
+	}
+
+	const ContainerHeader* header = (const ContainerHeader*)data;
+	const Format format = (Format)header->m_Format;
+
+	if (header->m_Magic != c_Magic || header->m_Version != c_Version || header->m_Format > (unsigned int)Format::BC5
+		|| header->m_NumberOfLevels == 0 || header->m_NumberOfLevels > c_MaxLevels || (header->m_Flipped != 0) != flip)
+	{
+		return 0;
+	}
+
+	unsigned long long sourceSize;
+	long long sourceTime;
+
+	// The source image may not be shipped at all, the container is then used as is.
+	if (getSourceStamp(sourceFilepath, sourceSize, sourceTime) && (header->m_SourceSize != sourceSize || header->m_SourceTime != sourceTime))
+	{
+		std::cout << "[INFO] TEXTURE CONTAINER: \"" << filepath << "\" is out of date, loading the source image instead." << std::endl;
+
+		return 0;
+	}
+
+	// The mips of a color space don't suit the other, the source image is decoded again instead.
+	if ((header->m_SRGB != 0) != gammaCorrection)
+	{
+		std::cout << "[INFO] TEXTURE CONTAINER: \"" << filepath << "\" was compressed for another color space, loading the source image instead." << std::endl;
+
+		return 0;
+	}
+
+	if (!isSupported(format, gammaCorrection))
+	{
+		return 0;
+	}
+
+	const LevelRecord* levels = (const LevelRecord*)(data + sizeof(ContainerHeader));
+
+	if (sizeof(ContainerHeader) + header->m_NumberOfLevels * sizeof(LevelRecord) > size)
+	{
+		return 0;
+	}
+
+	// A truncated or corrupted file must not make us read past the mapping.
+	for (unsigned int i = 0; i < header->m_NumberOfLevels; i++)
+	{
+		if (levels[i].m_Offset + levels[i].m_Size > size || levels[i].m_Size != getLevelSize(format, levels[i].m_Width, levels[i].m_Height))
+		{
+			std::cout << "[ERROR] TEXTURE CONTAINER: \"" << filepath << "\" is corrupted." << std::endl;
+
+			return 0;
+		}
+	}
+
+	unsigned int textureID;
+	int internalFormat = getInternalFormat(format, gammaCorrection);
+	size_t textureSize = 0;
+
+	glGenTextures(1, &textureID);
+	GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D, textureID);
+
+	for (unsigned int i = 0; i < header->m_NumberOfLevels; i++)
+	{
+		const LevelRecord& level = levels[i];
+
+		if (format == Format::RGBA8)
+		{
+			glTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.m_Width, level.m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data + level.m_Offset);
+		}
+		else
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.m_Width, level.m_Height, 0, (int)level.m_Size, data + level.m_Offset);
+		}
+
+		textureSize += level.m_Size;
+	}
+
+	// Same wrapping modes as the images decoded at runtime.
+	int wrapMode = header->m_ColorChannels == 4 ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header->m_NumberOfLevels - 1);
+
+	ResourceTracker::track(ResourceTracker::Category::TEXTURE, textureID, textureSize);
+
+	return textureID;
+}
+
+bool TextureContainer::store(const std::string& sourceFilepath, const Format format, const int colorChannels, const bool flipped, const bool srgb, const std::vector<Level>& levels)
+{
+	ContainerHeader header = { c_Magic, c_Version, (unsigned int)format, (unsigned int)colorChannels, flipped ? 1u : 0u, srgb ? 1u : 0u, (unsigned int)levels.size(), 0, 0 };
+
+	if (levels.empty() || levels.size() > c_MaxLevels || !getSourceStamp(sourceFilepath, header.m_SourceSize, header.m_SourceTime))
+	{
+		return false;
+	}
+
+	std::vector<LevelRecord> records;
+	unsigned long long offset = sizeof(ContainerHeader) + levels.size() * sizeof(LevelRecord);
+
+	for (const Level& level : levels)
+	{
+		records.push_back({ (unsigned int)level.m_Width, (unsigned int)level.m_Height, offset, level.m_Data.size() });
+
+		offset += level.m_Data.size();
+	}
+
+	// Written aside and renamed, so a crash never leaves a partial container behind.
+	const std::string filepath = getFilepath(sourceFilepath);
+	const std::string temporaryFilepath = filepath + ".tmp";
+
+	{
+		std::ofstream file(temporaryFilepath, std::ios::binary | std::ios::trunc);
+
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)records.data(), records.size() * sizeof(LevelRecord));
+
+		for (const Level& level : levels)
+		{
+			file.write((const char*)level.m_Data.data(), level.m_Data.size());
+		}
+
+		if (!file)
+		{
+			std::cout << "[ERROR] TEXTURE CONTAINER: Failed to write \"" << temporaryFilepath << "\"." << std::endl;
+
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryFilepath, filepath, error);
+
+	return !error;
+}
+
+bool TextureContainer::isSupported(const Format format, const bool gammaCorrection)
+{
+	switch (format)
+	{
+	case Format::BC1:
+	case Format::BC3:
+		return GLAD_GL_EXT_texture_compression_s3tc && (!gammaCorrection || GLAD_GL_EXT_texture_sRGB);
+
+	default:
+		return true; // RGTC and sRGB RGBA8 are core since OpenGL 3.0.
+	}
+}
+
+size_t TextureContainer::getLevelSize(const Format format, const int width, const int height)
+{
+	// Compressed levels are made of 4x4 blocks, partial blocks included.
+	size_t numberOfBlocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+
+	switch (format)
+	{
+	case Format::BC1:
+		return numberOfBlocks * 8;
+
+	case Format::BC3:
+	case Format::BC5:
+		return numberOfBlocks * 16;
+
+	default:
+		return (size_t)width * height * 4;
+	}
+}
+
+std::string TextureContainer::getFilepath(const std::string& sourceFilepath)
+{
+	return sourceFilepath + ".ltex";
+}
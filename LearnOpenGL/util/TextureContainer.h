@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+#include <glad/glad.h>
+
+#include "MappedFile.h"
+#include "../core/ResourceTracker.h"
+#include "../core/GLStateCache.h"
+
+// GPU-ready texture file (".ltex"), written next to its source image by the texture compressor.
+//
+// It holds the whole mip chain, either block-compressed (BC1 for color, BC3 for color with
+// alpha, BC5 for normal maps) or as plain RGBA8, so loading it needs neither an image decode
+// nor "glGenerateMipmap": the levels are uploaded straight from the mapped file. Containers
+// older than their source image, or built for the other color space, are ignored.
+class TextureContainer
+{
+public:
+	enum class Format : unsigned int { RGBA8, BC1, BC3, BC5 };
+
+	struct Level
+	{
+		int m_Width;
+		int m_Height;
+		std::vector<unsigned char> m_Data;
+	};
+
+	static unsigned int load(const std::string& sourceFilepath, const bool gammaCorrection, const bool flip);
+	static bool store(const std::string& sourceFilepath, const Format format, const int colorChannels, const bool flipped, const bool srgb, const std::vector<Level>& levels);
+
+	static bool isSupported(const Format format, const bool gammaCorrection);
+	static size_t getLevelSize(const Format format, const int width, const int height);
+	static std::string getFilepath(const std::string& sourceFilepath);
+};
@@ -0,0 +1,430 @@
+#include "TextureManager.h"
+
+TextureManager::TextureManager(const size_t uploadBudget)
+	: m_Requests(), m_PBO(), m_UploadBudget(uploadBudget)
+{
+	glGenBuffers(1, &m_PBO);
+}
+
+TextureManager::~TextureManager()
+{
+	// Images still being decoded are freed along with their futures.
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_PBO);
+
+	glDeleteBuffers(1, &m_PBO);
+}
+
+unsigned int TextureManager::load(const std::string& filepath, const bool gammaCorrection, const bool flip, const glm::vec4& placeholder)
+{
+	unsigned int textureID = createPlaceholder(GL_TEXTURE_2D, placeholder);
+
+	submit(textureID, GL_TEXTURE_2D, gammaCorrection, flip, { filepath }, placeholder);
+
+	return textureID;
+}
+
+unsigned int TextureManager::loadCubeMap(const std::array<std::string, 6>& filepaths, const glm::vec4& placeholder)
+{
+	unsigned int textureID = createPlaceholder(GL_TEXTURE_CUBE_MAP, placeholder);
+
+	// Cube map faces aren't flipped, their origin is the top left corner.
+	submit(textureID, GL_TEXTURE_CUBE_MAP, false, false, std::vector<std::string>(filepaths.begin(), filepaths.end()), placeholder);
+
+	return textureID;
+}
+
+void TextureManager::release(const unsigned int textureID)
+{
+	m_Requests.remove_if([textureID](const Request& request) { return request.m_ID == textureID; });
+
+	ResourceTracker::untrack(ResourceTracker::Category::TEXTURE, textureID);
+
+	glDeleteTextures(1, &textureID);
+}
+
+void TextureManager::update()
+{
+	size_t uploadedBytes = 0;
+
+	for (auto it = m_Requests.begin(); it != m_Requests.end(); )
+	{
+		Request& request = *it;
+
+		// Later requests may be decoded first, they don't wait for this one.
+		if (!request.m_Decoded)
+		{
+			if (request.m_Future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				it++;
+
+				continue;
+			}
+
+			request.m_Images = request.m_Future.get();
+			request.m_Decoded = true;
+		}
+
+		size_t size = 0;
+
+		for (const Image& image : request.m_Images)
+		{
+			size += getSize(image);
+		}
+
+		// At least one texture is uploaded per frame, so images over the budget still get through.
+		if (uploadedBytes > 0 && uploadedBytes + size > m_UploadBudget)
+		{
+			break;
+		}
+
+		upload(request);
+
+		uploadedBytes += size;
+		it = m_Requests.erase(it);
+	}
+}
+
+bool TextureManager::isLoaded(const unsigned int textureID) const
+{
+	for (const Request& request : m_Requests)
+	{
+		if (request.m_ID == textureID)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t TextureManager::getNumberOfPendingTextures() const
+{
+	return m_Requests.size();
+}
+
+TextureManager::Image TextureManager::decode(const std::string& filepath, const bool flip)
+{
+	Image image;
+
+	// The flag of "stbi_set_flip_vertically_on_load" is global, workers use their own.
+	stbi_set_flip_vertically_on_load_thread(flip);
+
+	image.m_Data.reset(stbi_load(filepath.c_str(), &image.m_Width, &image.m_Height, &image.m_ColorChannels, 0));
+
+	return image;
+}
+
+unsigned int TextureManager::createTexture(const Image& image, const bool gammaCorrection, const std::string& filepath)
+{
+	unsigned int textureID;
+
+	glGenTextures(1, &textureID);
+	GLStateCache::bindTextureForUpdate(GL_TEXTURE_2D, textureID);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	bool specified = false;
+
+	if (image.m_Data)
+	{
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Rows of RGB images aren't 4-byte aligned.
+
+		specified = specify(GL_TEXTURE_2D, image, gammaCorrection, image.m_Data.get());
+
+		if (specified)
+		{
+			glGenerateMipmap(GL_TEXTURE_2D);
+
+			ResourceTracker::track(ResourceTracker::Category::TEXTURE, textureID, ResourceTracker::getTextureSize(GL_RGBA8, image.m_Width, image.m_Height, true));
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	else
+	{
+		std::cout << "[ERROR] TEXTURE MANAGER: Failed to load texture in \"" << filepath << "\"." << std::endl;
+	}
+
+	// Without storage, the texture would be incomplete, callers get no texture instead.
+	if (!specified)
+	{
+		GLStateCache::forgetTexture(textureID);
+		glDeleteTextures(1, &textureID);
+
+		return 0;
+	}
+
+	return textureID;
+}
+
+unsigned int TextureManager::createCubeMap(const std::array<std::string, 6>& filepaths)
+{
+	std::vector<Image> images;
+
+	// Every face must decode, a partial cube map would be incomplete (and sample black).
+	for (const std::string& filepath : filepaths)
+	{
+		images.push_back(decode(filepath, false));
+
+		if (!images.back().m_Data)
+		{
+			std::cout << "[ERROR] TEXTURE MANAGER: Failed to load texture in \"" << filepath << "\"." << std::endl;
+
+			return 0;
+		}
+	}
+
+	unsigned int textureID;
+	bool specified = true;
+
+	glGenTextures(1, &textureID);
+	GLStateCache::bindTextureForUpdate(GL_TEXTURE_CUBE_MAP, textureID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Rows of RGB images aren't 4-byte aligned.
+
+	size_t size = 0;
+
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		// Texture Target					Orientation
+		// 
+		// GL_TEXTURE_CUBE_MAP_POSITIVE_X	Right
+		// GL_TEXTURE_CUBE_MAP_NEGATIVE_X	Left
+		// GL_TEXTURE_CUBE_MAP_POSITIVE_Y	Top
+		// GL_TEXTURE_CUBE_MAP_NEGATIVE_Y	Bottom
+		// GL_TEXTURE_CUBE_MAP_POSITIVE_Z	Back
+		// GL_TEXTURE_CUBE_MAP_NEGATIVE_Z	Front
+		//
+		specified &= specify(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, images[i], false, images[i].m_Data.get());
+
+		size += ResourceTracker::getTextureSize(GL_RGBA8, images[i].m_Width, images[i].m_Height);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if (!specified)
+	{
+		GLStateCache::forgetTexture(textureID);
+		glDeleteTextures(1, &textureID);
+
+		return 0;
+	}
+
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+	ResourceTracker::track(ResourceTracker::Category::TEXTURE, textureID, size);
+
+	return textureID;
+}
+
+unsigned int TextureManager::createPlaceholder(const int target, const glm::vec4& placeholder)
+{
+	unsigned int textureID;
+
+	glGenTextures(1, &textureID);
+	GLStateCache::bindTextureForUpdate(target, textureID);
+
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	specifyPlaceholder(target, placeholder);
+
+	ResourceTracker::track(ResourceTracker::Category::TEXTURE, textureID, target == GL_TEXTURE_CUBE_MAP ? 6 * 4 : 4);
+
+	return textureID;
+}
+
+void TextureManager::submit(const unsigned int textureID, const int target, const bool gammaCorrection, const bool flip, const std::vector<std::string>& filepaths, const glm::vec4& placeholder)
+{
+	Request request = { textureID, target, gammaCorrection, filepaths, placeholder, {}, {}, false };
+
+	request.m_Future = ThreadPool::getShared().submit([filepaths, flip]()
+	{
+		std::vector<Image> images;
+
+		for (const std::string& filepath : filepaths)
+		{
+			images.push_back(decode(filepath, flip));
+		}
+
+		return images;
+	});
+
+	m_Requests.push_back(std::move(request));
+}
+
+void TextureManager::upload(const Request& request)
+{
+	bool complete = true;
+	size_t textureSize = 0;
+
+	// Every image must decode, a partial cube map would be incomplete (and sample black).
+	for (size_t i = 0; i < request.m_Images.size(); i++)
+	{
+		if (!request.m_Images[i].m_Data)
+		{
+			std::cout << "[ERROR] TEXTURE MANAGER: Failed to load texture in \"" << request.m_Filepaths[i] << "\"." << std::endl;
+
+			complete = false;
+		}
+	}
+
+	// The placeholder is kept, with its sampling state.
+	if (!complete)
+	{
+		return;
+	}
+
+	GLStateCache::bindTextureForUpdate(request.m_Target, request.m_ID);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PBO);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Rows of RGB images aren't 4-byte aligned.
+
+	for (size_t i = 0; i < request.m_Images.size(); i++)
+	{
+		const Image& image = request.m_Images[i];
+		int target = request.m_Target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + (int)i : request.m_Target;
+		size_t size = getSize(image);
+
+		// Orphaning gives fresh storage, instead of waiting for the GPU to consume the previous upload.
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+		ResourceTracker::track(ResourceTracker::Category::BUFFER, m_PBO, size);
+
+		void* data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+		if (!data)
+		{
+			std::cout << "[ERROR] TEXTURE MANAGER: Failed to map the pixel unpack buffer." << std::endl;
+
+			complete = false;
+
+			break;
+		}
+
+		memcpy(data, image.m_Data.get(), size);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		// With a pixel unpack buffer bound, the data pointer is an offset into it.
+		if (!specify(target, image, request.m_GammaCorrection, nullptr))
+		{
+			complete = false;
+
+			break;
+		}
+
+		textureSize += ResourceTracker::getTextureSize(GL_RGBA8, image.m_Width, image.m_Height, request.m_Target == GL_TEXTURE_2D);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// A cube map failing midway gets its placeholder faces back, a 2D texture still has its own.
+	if (!complete && request.m_Target == GL_TEXTURE_CUBE_MAP)
+	{
+		specifyPlaceholder(GL_TEXTURE_CUBE_MAP, request.m_Placeholder);
+	}
+	else if (complete && request.m_Target == GL_TEXTURE_CUBE_MAP)
+	{
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	}
+	else if (complete)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	if (complete)
+	{
+		ResourceTracker::track(ResourceTracker::Category::TEXTURE, request.m_ID, textureSize);
+	}
+}
+
+void TextureManager::specifyPlaceholder(const int target, const glm::vec4& placeholder)
+{
+	unsigned char texel[4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		texel[i] = (unsigned char)(glm::clamp(placeholder[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	// No mipmaps, the minification filter must not expect any.
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+	if (target == GL_TEXTURE_CUBE_MAP)
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+		}
+	}
+	else
+	{
+		glTexImage2D(target, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+	}
+}
+
+size_t TextureManager::getSize(const Image& image)
+{
+	return (size_t)image.m_Width * image.m_Height * image.m_ColorChannels;
+}
+
+bool TextureManager::specify(const int target, const Image& image, const bool gammaCorrection, const void* pixels)
+{
+	int internalFormat, format;
+	int texture = target == GL_TEXTURE_2D ? GL_TEXTURE_2D : GL_TEXTURE_CUBE_MAP;
+
+	// Single and dual channel images (e.g. masks, roughness/metallic maps) have no sRGB format,
+	// they're always linear.
+	switch (image.m_ColorChannels)
+	{
+	case 1:
+		glTexParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		internalFormat = GL_R8;
+		format = GL_RED;
+
+		break;
+
+	case 2:
+		glTexParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		internalFormat = GL_RG8;
+		format = GL_RG;
+
+		break;
+
+	case 3:
+		glTexParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		internalFormat = gammaCorrection ? GL_SRGB : GL_RGB;
+		format = GL_RGB;
+
+		break;
+
+	case 4:
+		glTexParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		internalFormat = gammaCorrection ? GL_SRGB_ALPHA : GL_RGBA;
+		format = GL_RGBA;
+
+		break;
+
+	default:
+		std::cout << "[ERROR] TEXTURE MANAGER: Texture format not supported." << std::endl;
+
+		return false;
+	}
+
+	glTexImage2D(target, 0, internalFormat, image.m_Width, image.m_Height, 0, format, GL_UNSIGNED_BYTE, pixels);
+
+	return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <list>
+#include <array>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#if !defined _STB_IMAGE_INCLUDED
+#define _STB_IMAGE_INCLUDED
+
+#include <stb/stb_image.h>
+#endif // _STB_IMAGE_INCLUDED
+
+#include "ThreadPool.h"
+#include "../core/ResourceTracker.h"
+#include "../core/GLStateCache.h"
+
+// Loads textures in the background.
+//
+// "load" creates the texture right away, holding a 1x1 placeholder texel, and queues the
+// decoding of the image on the shared thread pool. "update", called once per frame on the
+// render thread, uploads the decoded images through a pixel unpack buffer, up to a byte budget
+// per frame, so streaming new assets doesn't stall a frame. The texture name never changes,
+// it can be bound (and sampled) while it's still loading.
+class TextureManager
+{
+public:
+	struct Image
+	{
+		int m_Width = 0;
+		int m_Height = 0;
+		int m_ColorChannels = 0;
+		std::unique_ptr<unsigned char, void(*)(void*)> m_Data = { nullptr, stbi_image_free };
+	};
+
+	TextureManager(const size_t uploadBudget = 8 * 1024 * 1024);
+	~TextureManager();
+
+	TextureManager(const TextureManager&) = delete;
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	unsigned int load(const std::string& filepath, const bool gammaCorrection = false, const bool flip = true, const glm::vec4& placeholder = glm::vec4(1.0f));
+	unsigned int loadCubeMap(const std::array<std::string, 6>& filepaths, const glm::vec4& placeholder = glm::vec4(1.0f));
+	void release(const unsigned int textureID);
+
+	void update();
+
+	bool isLoaded(const unsigned int textureID) const;
+	size_t getNumberOfPendingTextures() const;
+
+	static Image decode(const std::string& filepath, const bool flip);
+	static unsigned int createTexture(const Image& image, const bool gammaCorrection, const std::string& filepath); // 0 on failure.
+	static unsigned int createCubeMap(const std::array<std::string, 6>& filepaths); // 0 on failure.
+
+private:
+	struct Request
+	{
+		unsigned int m_ID;
+		int m_Target;
+		bool m_GammaCorrection;
+		std::vector<std::string> m_Filepaths;
+		glm::vec4 m_Placeholder; // Restored if a cube map face fails midway.
+		std::future<std::vector<Image>> m_Future;
+		std::vector<Image> m_Images; // Set once the future is ready.
+		bool m_Decoded;
+	};
+
+	std::list<Request> m_Requests; // In submission order.
+	unsigned int m_PBO;
+	size_t m_UploadBudget;
+
+	unsigned int createPlaceholder(const int target, const glm::vec4& placeholder);
+	void submit(const unsigned int textureID, const int target, const bool gammaCorrection, const bool flip, const std::vector<std::string>& filepaths, const glm::vec4& placeholder);
+	void upload(const Request& request);
+
+	static void specifyPlaceholder(const int target, const glm::vec4& placeholder);
+	static size_t getSize(const Image& image);
+	static bool specify(const int target, const Image& image, const bool gammaCorrection, const void* pixels);
+};
@@ -0,0 +1,64 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(const unsigned int numberOfThreads)
+	: m_Threads(), m_Tasks(), m_Mutex(), m_Condition(), m_Stopping(false)
+{
+	for (unsigned int i = 0; i < std::max(numberOfThreads, 1u); i++)
+	{
+		m_Threads.emplace_back(&ThreadPool::run, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		m_Stopping = true;
+	}
+
+	m_Condition.notify_all();
+
+	// Queued tasks are still run, their futures may be waited on.
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+}
+
+unsigned int ThreadPool::getNumberOfThreads() const
+{
+	return (unsigned int)m_Threads.size();
+}
+
+ThreadPool& ThreadPool::getShared()
+{
+	// One core is left to the main (GL) thread.
+	static ThreadPool threadPool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+
+	return threadPool;
+}
+
+void ThreadPool::run()
+{
+	while (true)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+
+			m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+
+			if (m_Tasks.empty())
+			{
+				return;
+			}
+
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <queue>
+#include <mutex>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of worker threads consuming a queue of tasks.
+//
+// "submit" returns a future, so callers can wait for (and get the result of) each task. Tasks
+// must not touch the GL context, which is only current on the main thread.
+class ThreadPool
+{
+public:
+	ThreadPool(const unsigned int numberOfThreads);
+	~ThreadPool();
+
+	template<typename Task>
+	auto submit(Task&& task) -> std::future<decltype(task())>
+	{
+		using Result = decltype(task());
+
+		// "std::function" must be copyable, hence the shared packaged task.
+		auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+		std::future<Result> future = packagedTask->get_future();
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_Tasks.push([packagedTask]() { (*packagedTask)(); });
+		}
+
+		m_Condition.notify_one();
+
+		return future;
+	}
+
+	unsigned int getNumberOfThreads() const;
+
+	static ThreadPool& getShared();
+
+private:
+	std::vector<std::thread> m_Threads;
+	std::queue<std::function<void()>> m_Tasks;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Stopping;
+
+	void run();
+};
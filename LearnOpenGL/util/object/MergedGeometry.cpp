@@ -0,0 +1,164 @@
+#include "MergedGeometry.h"
+
+MergedGeometry::MergedGeometry(const std::vector<MeshData>& meshes, const std::vector<std::vector<MeshTexture>>& textures)
+	: m_VAO(), m_VBO(), m_EBO(), m_IndirectBuffer(), m_Groups(), m_Commands(), m_Counts(), m_Offsets(), m_BaseVertices()
+{
+	// Meshes are bucketed by their bound texture names, each bucket becomes a group.
+	std::map<std::vector<std::pair<int, unsigned int>>, std::vector<size_t>> buckets;
+	std::vector<std::vector<MaterialBinding>> bindings(meshes.size());
+	std::vector<std::pair<unsigned int, int>> placements(meshes.size()); // First index and base vertex.
+
+	size_t numberOfVertices = 0, numberOfIndices = 0;
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		std::vector<std::pair<int, unsigned int>> material;
+
+		bindings[i] = Mesh::resolveMaterialBindings(textures[i]);
+
+		for (const MaterialBinding& binding : bindings[i])
+		{
+			material.emplace_back(binding.m_Unit, binding.m_TextureID);
+		}
+
+		buckets[material].push_back(i);
+
+		placements[i] = { (unsigned int)numberOfIndices, (int)numberOfVertices };
+		numberOfVertices += meshes[i].m_NumberOfVertices;
+		numberOfIndices += meshes[i].m_NumberOfIndices;
+	}
+
+	for (const auto& bucket : buckets)
+	{
+		const std::vector<size_t>& members = bucket.second;
+
+		m_Groups.push_back({ bindings[members[0]], (unsigned int)m_Commands.size(), (unsigned int)members.size() });
+
+		for (size_t i : members)
+		{
+			m_Commands.push_back({ meshes[i].m_NumberOfIndices, 1, placements[i].first, placements[i].second, 0 });
+
+			m_Counts.push_back((int)meshes[i].m_NumberOfIndices);
+			m_Offsets.push_back((const void*)(placements[i].first * sizeof(unsigned int)));
+			m_BaseVertices.push_back(placements[i].second);
+		}
+	}
+
+	glGenVertexArrays(1, &m_VAO);
+	glGenBuffers(1, &m_VBO);
+	glGenBuffers(1, &m_EBO);
+
+	GLStateCache::bindVertexArray(m_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+
+	glBufferData(GL_ARRAY_BUFFER, numberOfVertices * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, numberOfIndices * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+	// Each mesh is copied into its range straight from where it lives (e.g. a mapped cache file).
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, placements[i].second * sizeof(Vertex), meshes[i].m_NumberOfVertices * sizeof(Vertex), meshes[i].m_Vertices);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, placements[i].first * sizeof(unsigned int), meshes[i].m_NumberOfIndices * sizeof(unsigned int), meshes[i].m_Indices);
+	}
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(0));
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, m_Normal)));
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, m_TexCoords)));
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, m_Tangent)));
+
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glEnableVertexAttribArray(3);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	ResourceTracker::track(ResourceTracker::Category::VERTEX_ARRAY, m_VAO);
+	ResourceTracker::track(ResourceTracker::Category::BUFFER, m_VBO, numberOfVertices * sizeof(Vertex));
+	ResourceTracker::track(ResourceTracker::Category::BUFFER, m_EBO, numberOfIndices * sizeof(unsigned int));
+
+	if (isIndirectSupported())
+	{
+		// The commands never change, they're uploaded once.
+		glGenBuffers(1, &m_IndirectBuffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Commands.size() * sizeof(DrawElementsIndirectCommand), m_Commands.data(), GL_STATIC_DRAW);
+
+		ResourceTracker::track(ResourceTracker::Category::BUFFER, m_IndirectBuffer, m_Commands.size() * sizeof(DrawElementsIndirectCommand));
+	}
+
+	std::cout << "[INFO] MERGED GEOMETRY: " << meshes.size() << " meshes merged into " << m_Groups.size() << " draw calls (" << (m_IndirectBuffer ? "indirect" : "base vertex") << ")." << std::endl;
+}
+
+MergedGeometry::~MergedGeometry()
+{
+	ResourceTracker::untrack(ResourceTracker::Category::VERTEX_ARRAY, m_VAO);
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_VBO);
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_EBO);
+
+	glDeleteVertexArrays(1, &m_VAO);
+	glDeleteBuffers(1, &m_VBO);
+	glDeleteBuffers(1, &m_EBO);
+
+	if (m_IndirectBuffer)
+	{
+		ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_IndirectBuffer);
+
+		glDeleteBuffers(1, &m_IndirectBuffer);
+	}
+}
+
+void MergedGeometry::draw()
+{
+	GLStateCache::bindVertexArray(m_VAO);
+
+	for (size_t i = 0; i < m_Groups.size(); i++)
+	{
+		for (const MaterialBinding& binding : m_Groups[i].m_Bindings)
+		{
+			GLStateCache::bindTexture(binding.m_Unit, GL_TEXTURE_2D, binding.m_TextureID);
+		}
+
+		drawGroup(i);
+	}
+}
+
+void MergedGeometry::drawGroup(const size_t group)
+{
+	const MaterialGroup& materialGroup = m_Groups[group];
+
+	if (m_IndirectBuffer)
+	{
+		// Not part of the vertex array state, it's bound again in case another one replaced it.
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(materialGroup.m_FirstCommand * sizeof(DrawElementsIndirectCommand)), materialGroup.m_NumberOfCommands, 0);
+	}
+	else
+	{
+		unsigned int first = materialGroup.m_FirstCommand;
+
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, &m_Counts[first], GL_UNSIGNED_INT, &m_Offsets[first], materialGroup.m_NumberOfCommands, &m_BaseVertices[first]);
+	}
+}
+
+unsigned int MergedGeometry::getVAO() const
+{
+	return m_VAO;
+}
+
+const std::vector<MergedGeometry::MaterialGroup>& MergedGeometry::getGroups() const
+{
+	return m_Groups;
+}
+
+const std::vector<DrawElementsIndirectCommand>& MergedGeometry::getCommands() const
+{
+	return m_Commands;
+}
+
+bool MergedGeometry::isIndirectSupported()
+{
+	// Both are core since OpenGL 4.3, the indirect buffer binding comes with the first one.
+	return GLAD_GL_ARB_draw_indirect && GLAD_GL_ARB_multi_draw_indirect;
+}
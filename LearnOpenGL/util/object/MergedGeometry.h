@@ -0,0 +1,71 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include "Mesh.h"
+#include "MeshCache.h"
+
+#include "../../core/ResourceTracker.h"
+#include "../../core/GLStateCache.h"
+
+// Layout read by "glMultiDrawElementsIndirect", one per mesh.
+struct DrawElementsIndirectCommand
+{
+	unsigned int m_Count;
+	unsigned int m_InstanceCount;
+	unsigned int m_FirstIndex;
+	int m_BaseVertex;
+	unsigned int m_BaseInstance;
+};
+
+// All the meshes of a model in a single vertex buffer, a single element buffer and a single
+// vertex array, drawn with one multi-draw call per material instead of one draw call per mesh.
+//
+// Meshes sharing the same textures are grouped, their commands are contiguous. Groups are drawn
+// with "glMultiDrawElementsIndirect" from a buffer holding the commands when the context supports
+// it, and with "glMultiDrawElementsBaseVertex" (core since OpenGL 3.2) otherwise. The indices of
+// each mesh are kept relative to its first vertex, the base vertex offsets them.
+class MergedGeometry
+{
+public:
+	struct MaterialGroup
+	{
+		std::vector<MaterialBinding> m_Bindings;
+		unsigned int m_FirstCommand;
+		unsigned int m_NumberOfCommands;
+	};
+
+	MergedGeometry(const std::vector<MeshData>& meshes, const std::vector<std::vector<MeshTexture>>& textures);
+	~MergedGeometry();
+
+	MergedGeometry(const MergedGeometry&) = delete;
+	MergedGeometry& operator=(const MergedGeometry&) = delete;
+
+	// Same contract as "Mesh::draw", the program must already be bound.
+	void draw();
+
+	// Only issues the multi-draw of a group, its textures and the vertex array must be bound.
+	void drawGroup(const size_t group);
+
+	unsigned int getVAO() const;
+	const std::vector<MaterialGroup>& getGroups() const;
+	const std::vector<DrawElementsIndirectCommand>& getCommands() const;
+
+	static bool isIndirectSupported();
+
+private:
+	unsigned int m_VAO, m_VBO, m_EBO, m_IndirectBuffer; // No indirect buffer without support.
+
+	std::vector<MaterialGroup> m_Groups;
+	std::vector<DrawElementsIndirectCommand> m_Commands; // Ordered by group.
+
+	// The same commands, split for the fallback path.
+	std::vector<int> m_Counts;
+	std::vector<const void*> m_Offsets;
+	std::vector<int> m_BaseVertices;
+};
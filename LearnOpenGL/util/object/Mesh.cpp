@@ -1,18 +1,26 @@
 #include "Mesh.h"
 
 Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<MeshTexture>& textures)
-	: m_Vertices(vertices), m_Indices(indices), m_Textures(textures)
+	: Mesh(vertices.data(), (unsigned int)vertices.size(), indices.data(), (unsigned int)indices.size(), textures)
 {
+}
+
+Mesh::Mesh(const Vertex* vertices, const unsigned int numberOfVertices, const unsigned int* indices, const unsigned int numberOfIndices, const std::vector<MeshTexture>& textures)
+	: m_Textures(textures), m_VAO(), m_VBO(), m_EBO(), m_NumberOfVertices(numberOfVertices), m_NumberOfIndices(numberOfIndices), m_MaterialBindings(resolveMaterialBindings(textures)),
+	  m_BoundingBox(computeBoundingBox(vertices, numberOfVertices))
+{
+
 	glGenVertexArrays(1, &m_VAO);
 	glGenBuffers(1, &m_VBO);
 	glGenBuffers(1, &m_EBO);
 
-	glBindVertexArray(m_VAO);
+	GLStateCache::bindVertexArray(m_VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
 
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+	// The data may point into a mapped cache file, it's uploaded from there without any copy.
+	glBufferData(GL_ARRAY_BUFFER, numberOfVertices * sizeof(Vertex), vertices, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, numberOfIndices * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(0));
 	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, m_Normal)));
@@ -24,63 +32,150 @@ Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>&
 	glEnableVertexAttribArray(2);
 	glEnableVertexAttribArray(3);
 
-	glBindVertexArray(0); // Unbind the VAO before any other buffer.
+	// The VAO stays bound, unbinding the element buffer now would detach it.
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	ResourceTracker::track(ResourceTracker::Category::VERTEX_ARRAY, m_VAO);
+	ResourceTracker::track(ResourceTracker::Category::BUFFER, m_VBO, numberOfVertices * sizeof(Vertex));
+	ResourceTracker::track(ResourceTracker::Category::BUFFER, m_EBO, numberOfIndices * sizeof(unsigned int));
 }
 
 Mesh::~Mesh()
 {
-	// TODO: Performs clean-up of all buffers allocated in GPU memory.
+	ResourceTracker::untrack(ResourceTracker::Category::VERTEX_ARRAY, m_VAO);
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_VBO);
+	ResourceTracker::untrack(ResourceTracker::Category::BUFFER, m_EBO);
+
+	glDeleteVertexArrays(1, &m_VAO);
+	glDeleteBuffers(1, &m_VBO);
+	glDeleteBuffers(1, &m_EBO);
 }
 
-void Mesh::draw(ShaderProgram* shaderProgram)
+Mesh::Mesh(Mesh&& other) noexcept
+	: m_Textures(), m_VAO(), m_VBO(), m_EBO(), m_NumberOfVertices(), m_NumberOfIndices(), m_MaterialBindings(), m_BoundingBox()
 {
-	unsigned int texNumber[] = { 0, 0 }; // Buffer to carry the diffuse and specular positions.
+	*this = std::move(other);
+}
 
-	for (unsigned int i = 0; i < m_Textures.size(); i++)
+Mesh& Mesh::operator=(Mesh&& other) noexcept
+{
+	// The previous buffers are deleted along with "other".
+	std::swap(m_Textures, other.m_Textures);
+	std::swap(m_VAO, other.m_VAO);
+	std::swap(m_VBO, other.m_VBO);
+	std::swap(m_EBO, other.m_EBO);
+	std::swap(m_NumberOfVertices, other.m_NumberOfVertices);
+	std::swap(m_NumberOfIndices, other.m_NumberOfIndices);
+	std::swap(m_MaterialBindings, other.m_MaterialBindings);
+	std::swap(m_BoundingBox, other.m_BoundingBox);
+
+	return *this;
+}
+
+void Mesh::draw()
+{
+	for (const MaterialBinding& binding : m_MaterialBindings)
 	{
-		std::string uniformName = "";
+		GLStateCache::bindTexture(binding.m_Unit, GL_TEXTURE_2D, binding.m_TextureID);
+	}
 
-		if (m_Textures[i].m_Type == "TEXTURE_DIFFUSE")
-		{
-			uniformName += "uMaterial.diffuseMaps[" + std::to_string(texNumber[0]++) + "]";
-		}
-		else if (m_Textures[i].m_Type == "TEXTURE_SPECULAR")
-		{
-			uniformName += "uMaterial.specularMaps[" + std::to_string(texNumber[1]++) + "]";
-		}
-		else if (m_Textures[i].m_Type == "TEXTURE_NORMAL")
-		{
-			uniformName += "uMaterial.normalMaps[" + std::to_string(texNumber[1]++) + "]";
-		}
+	GLStateCache::bindVertexArray(m_VAO);
+	glDrawElements(GL_TRIANGLES, m_NumberOfIndices, GL_UNSIGNED_INT, 0);
+}
 
-		shaderProgram->setUniform1i(uniformName.c_str(), i);
+unsigned int Mesh::getVAO() const
+{
+	return m_VAO;
+}
 
-		// Activating and binding texture.
-		if (i >= 0 && i <= 15)
-		{
-			glActiveTexture(GL_TEXTURE0 + i);
-			glBindTexture(GL_TEXTURE_2D, m_Textures[i].m_ID);
-		}
-		else
+unsigned int Mesh::getNumberOfIndices() const
+{
+	return m_NumberOfIndices;
+}
+
+const std::vector<MaterialBinding>& Mesh::getMaterialBindings() const
+{
+	return m_MaterialBindings;
+}
+
+const BoundingBox& Mesh::getBoundingBox() const
+{
+	return m_BoundingBox;
+}
+
+void Mesh::setMaterialUnits(ShaderProgram* shaderProgram, const unsigned int usedUnits)
+{
+	const char* arrayNames[] = { "uMaterial.diffuseMaps", "uMaterial.specularMaps", "uMaterial.normalMaps" };
+
+	// Samplers of unused units are skipped, the program would report them as missing otherwise.
+	for (int unit = 0; unit < (int)MeshTextureType::NUMBER_OF_TYPES * s_MaxMapsPerType; unit++)
+	{
+		if (usedUnits & (1u << unit))
 		{
-			std::cout << "[ERROR] MESH: Failed to bind texture in " << i << " unit." << std::endl;
+			std::string samplerName = std::string(arrayNames[unit / s_MaxMapsPerType]) + "[" + std::to_string(unit % s_MaxMapsPerType) + "]";
 
-			return;
+			shaderProgram->setSamplerUnit(samplerName.c_str(), unit);
 		}
 	}
+}
 
-	shaderProgram->bind();
+MeshTextureType Mesh::getTextureType(const std::string& type)
+{
+	if (type == "TEXTURE_DIFFUSE")
+	{
+		return MeshTextureType::DIFFUSE;
+	}
+	else if (type == "TEXTURE_SPECULAR")
+	{
+		return MeshTextureType::SPECULAR;
+	}
+	else if (type == "TEXTURE_NORMAL")
+	{
+		return MeshTextureType::NORMAL;
+	}
 
-	glBindVertexArray(m_VAO);
-	glDrawElements(GL_TRIANGLES, m_Indices.size(), GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-	
-	shaderProgram->unbind();
+	return MeshTextureType::NUMBER_OF_TYPES;
 }
 
-unsigned int Mesh::getVAO() const
+BoundingBox Mesh::computeBoundingBox(const Vertex* vertices, const unsigned int numberOfVertices)
 {
-	return m_VAO;
+	BoundingBox box;
+
+	for (unsigned int i = 0; i < numberOfVertices; i++)
+	{
+		box.extend(vertices[i].m_Position);
+	}
+
+	return box;
+}
+
+std::vector<MaterialBinding> Mesh::resolveMaterialBindings(const std::vector<MeshTexture>& textures)
+{
+	std::vector<MaterialBinding> bindings;
+	int numberOfMaps[(int)MeshTextureType::NUMBER_OF_TYPES] = {}; // Next array index of each type.
+
+	for (const MeshTexture& texture : textures)
+	{
+		MeshTextureType type = getTextureType(texture.m_Type);
+
+		if (type == MeshTextureType::NUMBER_OF_TYPES)
+		{
+			std::cout << "[ERROR] MESH: Unknown texture type \"" << texture.m_Type << "\"." << std::endl;
+
+			continue;
+		}
+
+		int& index = numberOfMaps[(int)type];
+
+		if (index >= s_MaxMapsPerType)
+		{
+			std::cout << "[ERROR] MESH: Too many \"" << texture.m_Type << "\" textures, \"" << texture.m_RelativeFilepath << "\" is ignored." << std::endl;
+
+			continue;
+		}
+
+		bindings.push_back({ type, (int)type * s_MaxMapsPerType + index++, texture.m_ID });
+	}
+
+	return bindings;
 }
\ No newline at end of file
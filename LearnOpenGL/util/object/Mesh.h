@@ -2,12 +2,17 @@
 
 #include <string>
 #include <vector>
+#include <utility>
+#include <iostream>
 
 #include <glad/glad.h>
 
 #include <glm/glm.hpp>
 
 #include "../../core/ShaderProgram.h"
+#include "../../core/ResourceTracker.h"
+#include "../../core/GLStateCache.h"
+#include "../Frustum.h"
 
 struct Vertex
 {
@@ -23,25 +28,56 @@ struct MeshTexture
     std::string m_Type;
     std::string m_RelativeFilepath;
 
+    // Only a reference, the texture itself is owned by the texture cache (see "Model").
     MeshTexture(const int id, const std::string& type, const std::string& filepath)
         : m_ID(id), m_Type(type), m_RelativeFilepath(filepath) {}
-    ~MeshTexture() { /* TODO: Performs clean-up of all buffers allocated in GPU memory. */ }
+};
+
+enum class MeshTextureType { DIFFUSE, SPECULAR, NORMAL, NUMBER_OF_TYPES };
+
+// A texture of the mesh resolved to the fixed unit its "uMaterial" sampler reads from.
+struct MaterialBinding
+{
+    MeshTextureType m_Type;
+    int m_Unit;
+    unsigned int m_TextureID;
 };
 
 class Mesh
 {
 public:
     Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<MeshTexture>& textures);
+    Mesh(const Vertex* vertices, const unsigned int numberOfVertices, const unsigned int* indices, const unsigned int numberOfIndices, const std::vector<MeshTexture>& textures);
     ~Mesh();
 
-    void draw(ShaderProgram* shaderProgram);
+    Mesh(Mesh&& other) noexcept;
+    Mesh& operator=(Mesh&& other) noexcept;
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    // Only binds the textures and issues the draw call, the program must already be bound
+    // and its samplers set with "setMaterialUnits".
+    void draw();
 
     unsigned int getVAO() const;
+    unsigned int getNumberOfIndices() const;
+    const std::vector<MaterialBinding>& getMaterialBindings() const;
+    const BoundingBox& getBoundingBox() const;
+
+    static void setMaterialUnits(ShaderProgram* shaderProgram, const unsigned int usedUnits);
+    static MeshTextureType getTextureType(const std::string& type);
+    static std::vector<MaterialBinding> resolveMaterialBindings(const std::vector<MeshTexture>& textures);
+    static BoundingBox computeBoundingBox(const Vertex* vertices, const unsigned int numberOfVertices);
+
+    // Sampler "uMaterial.<type>Maps[i]" always reads from unit "type * s_MaxMapsPerType + i".
+    static const int s_MaxMapsPerType = 4;
 
-    std::vector<Vertex> m_Vertices;
-    std::vector<unsigned int> m_Indices;
     std::vector<MeshTexture> m_Textures;
 
 private:
     unsigned int m_VAO, m_VBO, m_EBO;
+    unsigned int m_NumberOfVertices, m_NumberOfIndices; // The geometry itself only lives in GPU memory.
+    std::vector<MaterialBinding> m_MaterialBindings; // Resolved once from "m_Textures".
+    BoundingBox m_BoundingBox; // In model space.
 };
\ No newline at end of file
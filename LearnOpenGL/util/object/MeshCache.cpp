@@ -0,0 +1,383 @@
+#include "MeshCache.h"
+
+const char* MeshCache::s_Directory = "cache/meshes";
+
+namespace
+{
+	const unsigned int c_Magic = 0x4D474F4C; // "LOGM".
+	const unsigned int c_Version = 3; // Bump it whenever the import output changes (e.g. the vertex processing).
+	const unsigned long long c_BlobAlignment = 16;
+
+	struct CacheHeader
+	{
+		unsigned int m_Magic;
+		unsigned int m_Version;
+		unsigned int m_VertexSize;
+		unsigned int m_NumberOfMeshes;
+		unsigned int m_NumberOfNodes;
+		unsigned int m_NumberOfTextures;
+		unsigned int m_StringsSize;
+		unsigned int m_ImportFlags;
+		unsigned long long m_SourceStamp; // See "getSourceStamp".
+	};
+
+	struct MeshRecord
+	{
+		unsigned long long m_VerticesOffset;
+		unsigned long long m_IndicesOffset;
+		unsigned int m_NumberOfVertices;
+		unsigned int m_NumberOfIndices;
+		unsigned int m_FirstTexture;
+		unsigned int m_NumberOfTextures;
+		unsigned int m_Node;
+	};
+
+	struct NodeRecord
+	{
+		float m_LocalMatrix[16];
+		int m_Parent;
+		unsigned int m_NameOffset, m_NameLength;
+	};
+
+	struct TextureRecord
+	{
+		unsigned int m_TypeOffset, m_TypeLength;
+		unsigned int m_FilepathOffset, m_FilepathLength;
+	};
+
+	unsigned long long alignTo(unsigned long long offset, unsigned long long alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	void hashBytes(unsigned long long& hash, const void* data, const size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= ((const unsigned char*)data)[i];
+			hash *= 0x100000001B3ull;
+		}
+	}
+
+	// Material libraries of an OBJ file, they're declared before its geometry.
+	std::vector<std::filesystem::path> getMaterialLibraries(const std::filesystem::path& sourceFilepath)
+	{
+		std::vector<std::filesystem::path> libraries;
+		std::ifstream file(sourceFilepath);
+		std::string line;
+
+		while (std::getline(file, line))
+		{
+			size_t first = line.find_first_not_of(' ', 7);
+			size_t last = line.find_last_not_of(" \r");
+
+			if (line.compare(0, 7, "mtllib ") == 0 && first != std::string::npos)
+			{
+				libraries.push_back(sourceFilepath.parent_path() / line.substr(first, last - first + 1));
+			}
+			else if (line.compare(0, 2, "v ") == 0 || line.compare(0, 2, "f ") == 0)
+			{
+				break;
+			}
+		}
+
+		// Exporters commonly name it after the model, whether it's declared or not.
+		std::filesystem::path sibling = std::filesystem::path(sourceFilepath).replace_extension(".mtl");
+
+		if (std::find(libraries.begin(), libraries.end(), sibling) == libraries.end())
+		{
+			libraries.push_back(sibling);
+		}
+
+		return libraries;
+	}
+
+	// 64-bit FNV-1a of the size and modification time of the source file and of its material
+	// libraries (missing ones included), so that editing a material invalidates the entry too.
+	bool getSourceStamp(const std::string& sourceFilepath, unsigned long long& stamp)
+	{
+		std::vector<std::filesystem::path> dependencies = { sourceFilepath };
+		std::error_code error;
+
+		if (std::filesystem::path(sourceFilepath).extension() == ".obj")
+		{
+			std::vector<std::filesystem::path> libraries = getMaterialLibraries(sourceFilepath);
+
+			dependencies.insert(dependencies.end(), libraries.begin(), libraries.end());
+		}
+
+		stamp = 0xCBF29CE484222325ull;
+
+		for (size_t i = 0; i < dependencies.size(); i++)
+		{
+			unsigned long long size = 0;
+			long long time = 0;
+			bool exists = std::filesystem::exists(dependencies[i], error);
+
+			if (exists)
+			{
+				size = std::filesystem::file_size(dependencies[i], error);
+				time = (long long)std::filesystem::last_write_time(dependencies[i], error).time_since_epoch().count();
+			}
+
+			// Only the source itself must exist, a missing library is part of the stamp.
+			if (i == 0 && (!exists || error))
+			{
+				return false;
+			}
+
+			std::string name = dependencies[i].generic_string();
+
+			hashBytes(stamp, name.data(), name.size());
+			hashBytes(stamp, &size, sizeof(size));
+			hashBytes(stamp, &time, sizeof(time));
+		}
+
+		return true;
+	}
+}
+
+bool MeshCache::load(const std::string& sourceFilepath, const unsigned int importFlags, const MappedFile& file, std::vector<MeshData>& meshes, std::vector<MeshNode>& nodes)
+{
+	const unsigned char* data = file.getData();
+	const unsigned long long size = file.getSize();
+
+	unsigned long long sourceStamp;
+
+	if (!file.isOpen() || size < sizeof(CacheHeader) || !getSourceStamp(sourceFilepath, sourceStamp))
+	{
+		return false;
+	}
+
+	const CacheHeader* header = (const CacheHeader*)data;
+
+	if (header->m_Magic != c_Magic || header->m_Version != c_Version || header->m_VertexSize != sizeof(Vertex)
+		|| header->m_ImportFlags != importFlags || header->m_SourceStamp != sourceStamp)
+	{
+		return false;
+	}
+
+	const unsigned long long tablesSize = sizeof(CacheHeader) + header->m_NumberOfMeshes * sizeof(MeshRecord) + header->m_NumberOfNodes * sizeof(NodeRecord)
+		+ header->m_NumberOfTextures * sizeof(TextureRecord) + header->m_StringsSize;
+
+	if (tablesSize > size)
+	{
+		return false;
+	}
+
+	const MeshRecord* meshRecords = (const MeshRecord*)(data + sizeof(CacheHeader));
+	const NodeRecord* nodeRecords = (const NodeRecord*)(meshRecords + header->m_NumberOfMeshes);
+	const TextureRecord* textureRecords = (const TextureRecord*)(nodeRecords + header->m_NumberOfNodes);
+	const char* strings = (const char*)(textureRecords + header->m_NumberOfTextures);
+
+	nodes.clear();
+	nodes.reserve(header->m_NumberOfNodes);
+
+	for (unsigned int i = 0; i < header->m_NumberOfNodes; i++)
+	{
+		const NodeRecord& record = nodeRecords[i];
+
+		if (record.m_Parent >= (int)i || (unsigned long long)record.m_NameOffset + record.m_NameLength > header->m_StringsSize)
+		{
+			std::cout << "[ERROR] MESH CACHE: \"" << getFilepath(sourceFilepath) << "\" is corrupted." << std::endl;
+
+			nodes.clear();
+
+			return false;
+		}
+
+		nodes.push_back({ std::string(strings + record.m_NameOffset, record.m_NameLength), glm::make_mat4(record.m_LocalMatrix), record.m_Parent });
+	}
+
+	meshes.clear();
+	meshes.reserve(header->m_NumberOfMeshes);
+
+	for (unsigned int i = 0; i < header->m_NumberOfMeshes; i++)
+	{
+		const MeshRecord& record = meshRecords[i];
+		MeshData mesh = { (const Vertex*)(data + record.m_VerticesOffset), record.m_NumberOfVertices, (const unsigned int*)(data + record.m_IndicesOffset), record.m_NumberOfIndices, {}, record.m_Node };
+
+		// A truncated or corrupted file must not make us read past the mapping.
+		if (record.m_VerticesOffset + (unsigned long long)record.m_NumberOfVertices * sizeof(Vertex) > size
+			|| record.m_IndicesOffset + (unsigned long long)record.m_NumberOfIndices * sizeof(unsigned int) > size
+			|| (unsigned long long)record.m_FirstTexture + record.m_NumberOfTextures > header->m_NumberOfTextures
+			|| record.m_Node >= header->m_NumberOfNodes)
+		{
+			std::cout << "[ERROR] MESH CACHE: \"" << getFilepath(sourceFilepath) << "\" is corrupted." << std::endl;
+
+			meshes.clear();
+
+			return false;
+		}
+
+		// Nor the GPU read past the vertices.
+		for (unsigned int j = 0; j < record.m_NumberOfIndices; j++)
+		{
+			if (mesh.m_Indices[j] >= record.m_NumberOfVertices)
+			{
+				std::cout << "[ERROR] MESH CACHE: \"" << getFilepath(sourceFilepath) << "\" is corrupted." << std::endl;
+
+				meshes.clear();
+
+				return false;
+			}
+		}
+
+		for (unsigned int j = 0; j < record.m_NumberOfTextures; j++)
+		{
+			const TextureRecord& texture = textureRecords[record.m_FirstTexture + j];
+
+			if ((unsigned long long)texture.m_TypeOffset + texture.m_TypeLength > header->m_StringsSize
+				|| (unsigned long long)texture.m_FilepathOffset + texture.m_FilepathLength > header->m_StringsSize)
+			{
+				meshes.clear();
+
+				return false;
+			}
+
+			mesh.m_Textures.push_back({ std::string(strings + texture.m_TypeOffset, texture.m_TypeLength), std::string(strings + texture.m_FilepathOffset, texture.m_FilepathLength) });
+		}
+
+		meshes.push_back(mesh);
+	}
+
+	return true;
+}
+
+void MeshCache::store(const std::string& sourceFilepath, const unsigned int importFlags, const std::vector<MeshData>& meshes, const std::vector<MeshNode>& nodes)
+{
+	CacheHeader header = { c_Magic, c_Version, sizeof(Vertex), (unsigned int)meshes.size(), (unsigned int)nodes.size(), 0, 0, importFlags, 0 };
+
+	if (!getSourceStamp(sourceFilepath, header.m_SourceStamp))
+	{
+		return;
+	}
+
+	std::vector<MeshRecord> meshRecords;
+	std::vector<NodeRecord> nodeRecords;
+	std::vector<TextureRecord> textureRecords;
+	std::string strings;
+
+	for (const MeshNode& node : nodes)
+	{
+		NodeRecord record = { {}, node.m_Parent, (unsigned int)strings.size(), (unsigned int)node.m_Name.size() };
+
+		std::memcpy(record.m_LocalMatrix, glm::value_ptr(node.m_LocalMatrix), sizeof(record.m_LocalMatrix));
+		strings += node.m_Name;
+
+		nodeRecords.push_back(record);
+	}
+
+	for (const MeshData& mesh : meshes)
+	{
+		meshRecords.push_back({ 0, 0, mesh.m_NumberOfVertices, mesh.m_NumberOfIndices, (unsigned int)textureRecords.size(), (unsigned int)mesh.m_Textures.size(), mesh.m_Node });
+
+		for (const MeshTextureReference& texture : mesh.m_Textures)
+		{
+			TextureRecord record = { (unsigned int)strings.size(), (unsigned int)texture.m_Type.size(), 0, (unsigned int)texture.m_RelativeFilepath.size() };
+
+			strings += texture.m_Type;
+			record.m_FilepathOffset = (unsigned int)strings.size();
+			strings += texture.m_RelativeFilepath;
+
+			textureRecords.push_back(record);
+		}
+	}
+
+	header.m_NumberOfTextures = (unsigned int)textureRecords.size();
+	header.m_StringsSize = (unsigned int)strings.size();
+
+	// Blobs follow the tables, each of them aligned.
+	unsigned long long offset = sizeof(CacheHeader) + meshRecords.size() * sizeof(MeshRecord) + nodeRecords.size() * sizeof(NodeRecord) + textureRecords.size() * sizeof(TextureRecord) + strings.size();
+
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		meshRecords[i].m_VerticesOffset = offset = alignTo(offset, c_BlobAlignment);
+		offset += (unsigned long long)meshes[i].m_NumberOfVertices * sizeof(Vertex);
+
+		meshRecords[i].m_IndicesOffset = offset = alignTo(offset, c_BlobAlignment);
+		offset += (unsigned long long)meshes[i].m_NumberOfIndices * sizeof(unsigned int);
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(s_Directory, error);
+
+	// Written aside and renamed, so a crash never leaves a partial cache file behind.
+	const std::string filepath = getFilepath(sourceFilepath);
+	const std::string temporaryFilepath = filepath + ".tmp";
+
+	{
+		std::ofstream file(temporaryFilepath, std::ios::binary | std::ios::trunc);
+
+		if (!file)
+		{
+			std::cout << "[ERROR] MESH CACHE: Failed to write \"" << temporaryFilepath << "\"." << std::endl;
+
+			return;
+		}
+
+		const char padding[c_BlobAlignment] = {};
+		unsigned long long position = 0;
+
+		auto write = [&](const void* data, unsigned long long size)
+		{
+			file.write((const char*)data, size);
+			position += size;
+		};
+
+		auto pad = [&](unsigned long long target)
+		{
+			write(padding, target - position);
+		};
+
+		write(&header, sizeof(header));
+		write(meshRecords.data(), meshRecords.size() * sizeof(MeshRecord));
+		write(nodeRecords.data(), nodeRecords.size() * sizeof(NodeRecord));
+		write(textureRecords.data(), textureRecords.size() * sizeof(TextureRecord));
+		write(strings.data(), strings.size());
+
+		for (unsigned int i = 0; i < meshes.size(); i++)
+		{
+			pad(meshRecords[i].m_VerticesOffset);
+			write(meshes[i].m_Vertices, (unsigned long long)meshes[i].m_NumberOfVertices * sizeof(Vertex));
+
+			pad(meshRecords[i].m_IndicesOffset);
+			write(meshes[i].m_Indices, (unsigned long long)meshes[i].m_NumberOfIndices * sizeof(unsigned int));
+		}
+
+		if (!file)
+		{
+			std::cout << "[ERROR] MESH CACHE: Failed to write \"" << temporaryFilepath << "\"." << std::endl;
+
+			return;
+		}
+	}
+
+	std::filesystem::rename(temporaryFilepath, filepath, error);
+
+	// E.g. the previous cache file is still mapped, the next run imports the model again.
+	if (error)
+	{
+		std::cout << "[ERROR] MESH CACHE: Failed to replace \"" << filepath << "\" (" << error.message() << ")." << std::endl;
+
+		std::filesystem::remove(temporaryFilepath, error);
+	}
+}
+
+std::string MeshCache::getFilepath(const std::string& sourceFilepath)
+{
+	const std::string normalizedFilepath = std::filesystem::path(sourceFilepath).lexically_normal().generic_string();
+
+	unsigned long long hash = 0xCBF29CE484222325ull; // 64-bit FNV-1a of the source filepath.
+	char buffer[17];
+
+	for (char c : normalizedFilepath)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 0x100000001B3ull;
+	}
+
+	snprintf(buffer, sizeof(buffer), "%016llx", hash);
+
+	return std::string(s_Directory) + "/" + buffer + ".mesh";
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Mesh.h"
+#include "../MappedFile.h"
+
+struct MeshTextureReference
+{
+	std::string m_Type;
+	std::string m_RelativeFilepath;
+};
+
+// View over the geometry of a mesh, either imported or mapped from a cache file.
+struct MeshData
+{
+	const Vertex* m_Vertices;
+	unsigned int m_NumberOfVertices;
+
+	const unsigned int* m_Indices;
+	unsigned int m_NumberOfIndices;
+
+	std::vector<MeshTextureReference> m_Textures;
+
+	unsigned int m_Node; // Index of the node the mesh is attached to.
+};
+
+// Node of an imported hierarchy, parents always come before their children.
+struct MeshNode
+{
+	std::string m_Name;
+	glm::mat4 m_LocalMatrix;
+	int m_Parent; // -1 for the root.
+};
+
+// On-disk cache of imported models, so Assimp only runs once per model.
+//
+// A cache file holds a header, a table of meshes, the node hierarchy, their texture references
+// and node names (in a string table), and the vertex and index blobs, 16-byte aligned. It's read
+// through a memory mapping and the meshes point straight into the mapped pages, so they're
+// uploaded to GL without any copy.
+// Entries are invalidated by a change of the source file or of its material libraries (size or
+// modification time), of the import flags, of the format version or of the "Vertex" layout.
+class MeshCache
+{
+public:
+	static bool load(const std::string& sourceFilepath, const unsigned int importFlags, const MappedFile& file, std::vector<MeshData>& meshes, std::vector<MeshNode>& nodes);
+	static void store(const std::string& sourceFilepath, const unsigned int importFlags, const std::vector<MeshData>& meshes, const std::vector<MeshNode>& nodes);
+
+	static std::string getFilepath(const std::string& sourceFilepath);
+
+private:
+	static const char* s_Directory;
+};
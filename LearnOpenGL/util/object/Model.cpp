@@ -1,20 +1,99 @@
 #include "Model.h"
 
-Model::Model(const char* filepath)
+Model::Model(const char* filepath, TextureManager* textureManager, const bool merged)
+	: m_Meshes(), m_MergedGeometry(), m_Merged(merged), m_Nodes(), m_MeshNodes(), m_MeshMatrices(), m_MeshWorldMatrices(), m_BoundingBox(), m_MeshBoundingBoxes(), m_MeshVisibility(), m_LoadedTextures(), m_Directory(), m_TextureManager(textureManager), m_MaterialProgram(), m_ModelMatrixHandle()
 {
 	loadModel(filepath);
 }
 
 Model::~Model()
 {
+	for (const MeshTexture& texture : m_LoadedTextures)
+	{
+		TextureCache::release(texture.m_ID);
+	}
+}
+
+void Model::draw(ShaderProgram* shaderProgram, const glm::mat4& modelMatrix, const Frustum* frustum)
+{
+	if (frustum && !cull(frustum->transform(modelMatrix)))
+	{
+		return;
+	}
+
+	prepareProgram(shaderProgram);
+
+	shaderProgram->bind();
+
+	if (m_MergedGeometry)
+	{
+		shaderProgram->setUniformMatrix4fv(m_ModelMatrixHandle, modelMatrix);
+		m_MergedGeometry->draw();
+	}
+
+	for (size_t i = 0; i < m_Meshes.size(); i++)
+	{
+		if (!frustum || m_MeshVisibility[i])
+		{
+			shaderProgram->setUniformMatrix4fv(m_ModelMatrixHandle, modelMatrix * m_MeshMatrices[i]);
+			m_Meshes[i].draw();
+		}
+	}
+
+	shaderProgram->unbind();
+}
+
+void Model::submit(RenderQueue& renderQueue, ShaderProgram* shaderProgram, const glm::mat4& modelMatrix, const unsigned int pass, const float depth, const Frustum* frustum)
+{
+	// The planes are moved into model space, the bounds are tested as they were loaded.
+	if (frustum && !cull(frustum->transform(modelMatrix)))
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_Meshes.size(); i++)
+	{
+		m_MeshWorldMatrices[i] = modelMatrix * m_MeshMatrices[i];
+	}
+
+	submitItems(renderQueue, shaderProgram, modelMatrix, pass, depth, frustum != nullptr);
+}
+
+void Model::submit(RenderQueue& renderQueue, ShaderProgram* shaderProgram, const SceneGraph& sceneGraph, const unsigned int instance, const unsigned int pass, const float depth, const Frustum* frustum)
+{
+	// Merged meshes have their node transforms baked in, only the instance node moves them.
+	if (m_MergedGeometry)
+	{
+		submit(renderQueue, shaderProgram, sceneGraph.getWorldMatrix(instance), pass, depth, frustum);
+
+		return;
+	}
+
+	for (size_t i = 0; i < m_Meshes.size(); i++)
+	{
+		m_MeshWorldMatrices[i] = sceneGraph.getWorldMatrix(instance + 1 + m_MeshNodes[i]);
+
+		// Each node may have moved on its own, every mesh has its own model space.
+		if (frustum)
+		{
+			m_MeshVisibility[i] = frustum->transform(m_MeshWorldMatrices[i]).isVisible(m_Meshes[i].getBoundingBox()) ? 1 : 0;
+		}
+	}
+
+	submitItems(renderQueue, shaderProgram, sceneGraph.getWorldMatrix(instance), pass, depth, frustum != nullptr);
 }
 
-void Model::draw(ShaderProgram* shaderProgram)
+unsigned int Model::instantiate(SceneGraph& sceneGraph, const unsigned int parent) const
 {
-	for (Mesh& mesh : m_Meshes)
+	// The instance node is the one to move, the imported nodes follow it in order.
+	unsigned int instance = sceneGraph.addNode(glm::mat4(1.0f), parent);
+
+	for (const MeshNode& node : m_Nodes)
 	{
-		mesh.draw(shaderProgram);
+		sceneGraph.addNode(node.m_LocalMatrix, node.m_Parent < 0 ? instance : instance + 1 + node.m_Parent, node.m_Name);
 	}
+
+	return instance;
 }
 
 const std::vector<Mesh>& Model::getMeshes()
@@ -22,64 +101,431 @@ const std::vector<Mesh>& Model::getMeshes()
 	return m_Meshes;
 }
 
+const MergedGeometry* Model::getMergedGeometry()
+{
+	return m_MergedGeometry.get();
+}
+
+const BoundingBox& Model::getBoundingBox()
+{
+	return m_BoundingBox;
+}
+
+const std::vector<MeshNode>& Model::getNodes()
+{
+	return m_Nodes;
+}
+
 const std::vector<MeshTexture>& Model::getLoadedTextures()
 {
 	return m_LoadedTextures;
 }
 
-void Model::loadModel(const std::string& filepath)
+void Model::submitItems(RenderQueue& renderQueue, ShaderProgram* shaderProgram, const glm::mat4& modelMatrix, const unsigned int pass, const float depth, const bool culled)
 {
-	Assimp::Importer importer;
+	TextureBinding textures[(int)MeshTextureType::NUMBER_OF_TYPES * Mesh::s_MaxMapsPerType];
 
-	// More post-processing options:
-	// 
-	//	aiProcess_GenNormals: creates normal vectors for each vertex if the model doesn't contain normal vectors.
-	//	aiProcess_SplitLargeMeshes: splits large meshes into smaller sub-meshes (which is useful if your rendering has a maximum number of vertices allowed and can only process smaller meshes).
-	//	aiProcess_OptimizeMeshes: does the reverse by trying to join several meshes into one larger mesh (reducing drawing calls for optimization).
-	// 
-	// http://assimp.sourceforge.net/lib_html/postprocess_8h.html
-	//
-	const aiScene* scene = importer.ReadFile(filepath, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+	prepareProgram(shaderProgram);
 
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	// One item per material group, each one issues a single multi-draw.
+	if (m_MergedGeometry)
 	{
-		std::cout << "[ERROR] MODEL: ASSIMP" << "\n" << importer.GetErrorString() << std::endl;
+		MergedGeometry* geometry = m_MergedGeometry.get();
+		const std::vector<MergedGeometry::MaterialGroup>& groups = geometry->getGroups();
+
+		for (size_t i = 0; i < groups.size(); i++)
+		{
+			unsigned int numberOfTextures = 0;
+
+			for (const MaterialBinding& binding : groups[i].m_Bindings)
+			{
+				textures[numberOfTextures++] = { binding.m_Unit, GL_TEXTURE_2D, binding.m_TextureID };
+			}
+
+			DrawItem item = {};
+			unsigned int materialID = RenderQueue::getMaterialID(textures, numberOfTextures);
+
+			item.m_Key = RenderQueue::makeKey(pass, shaderProgram->getID(), materialID, geometry->getVAO(), depth);
+			item.m_Program = shaderProgram;
+			item.m_VertexArrayID = geometry->getVAO();
+			item.m_ModelMatrix = modelMatrix;
+			item.m_ModelMatrixHandle = m_ModelMatrixHandle;
+			item.m_Draw = [geometry, i]() { geometry->drawGroup(i); };
 
+			renderQueue.submit(std::move(item), textures, numberOfTextures);
+		}
+	}
+
+	for (size_t i = 0; i < m_Meshes.size(); i++)
+	{
+		const Mesh& mesh = m_Meshes[i];
+		unsigned int numberOfTextures = 0;
+
+		if (culled && !m_MeshVisibility[i])
+		{
+			continue;
+		}
+
+		for (const MaterialBinding& binding : mesh.getMaterialBindings())
+		{
+			textures[numberOfTextures++] = { binding.m_Unit, GL_TEXTURE_2D, binding.m_TextureID };
+		}
+
+		DrawItem item = {};
+		unsigned int materialID = RenderQueue::getMaterialID(textures, numberOfTextures);
+
+		item.m_Key = RenderQueue::makeKey(pass, shaderProgram->getID(), materialID, mesh.getVAO(), depth);
+		item.m_Program = shaderProgram;
+		item.m_VertexArrayID = mesh.getVAO();
+		item.m_Mode = GL_TRIANGLES;
+		item.m_Count = mesh.getNumberOfIndices();
+		item.m_Indexed = true;
+		item.m_ModelMatrix = m_MeshWorldMatrices[i];
+		item.m_ModelMatrixHandle = m_ModelMatrixHandle;
+
+		renderQueue.submit(std::move(item), textures, numberOfTextures);
+	}
+}
+
+void Model::prepareProgram(ShaderProgram* shaderProgram)
+{
+	if (shaderProgram == m_MaterialProgram)
+	{
 		return;
 	}
 
+	unsigned int usedUnits = 0;
+
+	if (m_MergedGeometry)
+	{
+		for (const MergedGeometry::MaterialGroup& group : m_MergedGeometry->getGroups())
+		{
+			for (const MaterialBinding& binding : group.m_Bindings)
+			{
+				usedUnits |= 1u << binding.m_Unit;
+			}
+		}
+	}
+
+	for (const Mesh& mesh : m_Meshes)
+	{
+		for (const MaterialBinding& binding : mesh.getMaterialBindings())
+		{
+			usedUnits |= 1u << binding.m_Unit;
+		}
+	}
+
+	// Both are remembered by the program itself, so they follow its reloads.
+	Mesh::setMaterialUnits(shaderProgram, usedUnits);
+
+	m_MaterialProgram = shaderProgram;
+	m_ModelMatrixHandle = shaderProgram->getUniformHandle("uModelMatrix");
+}
+
+bool Model::cull(const Frustum& frustum)
+{
+	if (m_MergedGeometry)
+	{
+		return frustum.isVisible(m_BoundingBox);
+	}
+
+	return frustum.cull(m_MeshBoundingBoxes, m_MeshVisibility.data()) > 0;
+}
+
+void Model::loadModel(const std::string& filepath)
+{
+	using Clock = std::chrono::steady_clock;
+
+	auto getMilliseconds = [](const Clock::time_point& start, const Clock::time_point& end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	};
+
+	ThreadPool& threadPool = ThreadPool::getShared();
+	Clock::time_point startTime = Clock::now();
+
 	m_Directory = filepath.substr(0, filepath.find_last_of('/'));
 
-	processNode(scene->mRootNode, scene);
+	// The meshes point either into the mapped file or into the imported meshes, which must
+	// outlive their upload.
+	MappedFile cacheFile(MeshCache::getFilepath(filepath));
+	std::vector<MeshData> meshes;
+	std::vector<ImportedMesh> importedMeshes;
+
+	bool cached = MeshCache::load(filepath, s_ImportFlags, cacheFile, meshes, m_Nodes);
+	Clock::time_point importTime = Clock::now();
+
+	if (!cached)
+	{
+		// Stale or invalid, it's replaced by "store" below.
+		cacheFile.close();
+
+		Assimp::Importer importer;
+
+		// More post-processing options:
+		// 
+		//	aiProcess_GenNormals: creates normal vectors for each vertex if the model doesn't contain normal vectors.
+		//	aiProcess_SplitLargeMeshes: splits large meshes into smaller sub-meshes (which is useful if your rendering has a maximum number of vertices allowed and can only process smaller meshes).
+		//	aiProcess_OptimizeMeshes: does the reverse by trying to join several meshes into one larger mesh (reducing drawing calls for optimization).
+		// 
+		// http://assimp.sourceforge.net/lib_html/postprocess_8h.html
+		//
+		// Tangents are computed per mesh on the worker threads (see "calculateTangents"), instead
+		// of with "aiProcess_CalcTangentSpace", which runs serially inside "ReadFile".
+		//
+		const aiScene* scene = importer.ReadFile(filepath, s_ImportFlags);
+
+		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+		{
+			std::cout << "[ERROR] MODEL: ASSIMP" << "\n" << importer.GetErrorString() << std::endl;
+
+			return;
+		}
+
+		importTime = Clock::now();
+
+		std::vector<const aiMesh*> sceneMeshes;
+		std::vector<unsigned int> meshNodes;
+		std::vector<std::future<void>> tasks;
+
+		m_Nodes.clear();
+		processNode(scene->mRootNode, scene, -1, sceneMeshes, meshNodes);
+
+		// Every mesh is converted independently, in node order.
+		importedMeshes.resize(sceneMeshes.size());
+
+		for (size_t i = 0; i < sceneMeshes.size(); i++)
+		{
+			tasks.push_back(threadPool.submit([&, i]() { importedMeshes[i] = processMesh(sceneMeshes[i], scene); }));
+		}
+
+		for (std::future<void>& task : tasks)
+		{
+			task.get();
+		}
+
+		for (size_t i = 0; i < importedMeshes.size(); i++)
+		{
+			const ImportedMesh& mesh = importedMeshes[i];
+
+			meshes.push_back({ mesh.m_Vertices.data(), (unsigned int)mesh.m_Vertices.size(), mesh.m_Indices.data(), (unsigned int)mesh.m_Indices.size(), mesh.m_Textures, meshNodes[i] });
+		}
+
+		// The next runs load the model from the cache, without Assimp.
+		MeshCache::store(filepath, s_ImportFlags, meshes, m_Nodes);
+	}
+
+	Clock::time_point meshesTime = Clock::now();
+
+	// Each texture is loaded once per process, even if it's shared by several meshes or models.
+	std::vector<MeshTextureReference> missingTextures;
+	std::unordered_map<std::string, unsigned int> textureIDs;
+
+	for (const MeshData& mesh : meshes)
+	{
+		for (const MeshTextureReference& reference : mesh.m_Textures)
+		{
+			if (textureIDs.count(reference.m_RelativeFilepath))
+			{
+				continue;
+			}
+
+			std::string completeFilepath = m_Directory + "/" + reference.m_RelativeFilepath;
+			unsigned int textureID;
+
+			if (m_TextureManager)
+			{
+				// Placeholders are bound until the images are streamed in, a flat normal for normal maps.
+				glm::vec4 placeholder = reference.m_Type == "TEXTURE_NORMAL" ? glm::vec4(0.5f, 0.5f, 1.0f, 1.0f) : glm::vec4(1.0f);
+
+				textureID = TextureCache::load(completeFilepath, false, true, m_TextureManager, placeholder);
+			}
+			else
+			{
+				std::string key = TextureCache::getKey(completeFilepath, false, true);
+
+				textureID = TextureCache::acquire(key);
+
+				// Precompressed textures skip both the image decode and the mipmap generation.
+				if (!textureID)
+				{
+					textureID = TextureContainer::load(completeFilepath, false, true);
+
+					if (textureID)
+					{
+						TextureCache::insert(key, textureID, nullptr);
+					}
+				}
+			}
+
+			textureIDs[reference.m_RelativeFilepath] = textureID;
+
+			if (textureID)
+			{
+				m_LoadedTextures.emplace_back(textureID, reference.m_Type, reference.m_RelativeFilepath);
+			}
+			else
+			{
+				missingTextures.push_back(reference);
+			}
+		}
+	}
+
+	// Textures missing from the cache are decoded in parallel.
+	std::vector<std::future<TextureManager::Image>> decodedTextures;
+	std::vector<TextureManager::Image> textures;
+
+	for (const MeshTextureReference& reference : missingTextures)
+	{
+		std::string completeFilepath = m_Directory + "/" + reference.m_RelativeFilepath;
+
+		decodedTextures.push_back(threadPool.submit([completeFilepath]() { return TextureManager::decode(completeFilepath, true); }));
+	}
+
+	for (std::future<TextureManager::Image>& decodedTexture : decodedTextures)
+	{
+		textures.push_back(decodedTexture.get());
+	}
+
+	Clock::time_point texturesTime = Clock::now();
+
+	// GL stage, only the main thread owns the context.
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		const MeshTextureReference& reference = missingTextures[i];
+		std::string completeFilepath = m_Directory + "/" + reference.m_RelativeFilepath;
+		unsigned int textureID = TextureManager::createTexture(textures[i], false, completeFilepath);
+
+		textureIDs[reference.m_RelativeFilepath] = textureID;
+
+		if (textureID)
+		{
+			TextureCache::insert(TextureCache::getKey(completeFilepath, false, true), textureID, nullptr);
+			m_LoadedTextures.emplace_back(textureID, reference.m_Type, reference.m_RelativeFilepath);
+		}
+	}
+
+	createMeshes(meshes, textureIDs);
+
+	Clock::time_point uploadTime = Clock::now();
+
+	std::cout << "[INFO] MODEL: Loaded \"" << filepath << "\" (" << (cached ? "cache " : "import ") << getMilliseconds(startTime, importTime) << " ms, meshes " << getMilliseconds(importTime, meshesTime) << " ms, textures " << getMilliseconds(meshesTime, texturesTime) << " ms, upload " << getMilliseconds(texturesTime, uploadTime) << " ms)." << std::endl;
 }
 
-void Model::processNode(aiNode* node, const aiScene* scene)
+void Model::createMeshes(const std::vector<MeshData>& meshes, const std::unordered_map<std::string, unsigned int>& textureIDs)
 {
-	// Process all the node's meshes (if any).
-	for (unsigned int i = 0; i < node->mNumMeshes; i++)
+	std::vector<std::vector<MeshTexture>> textures(meshes.size());
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		for (const MeshTextureReference& reference : meshes[i].m_Textures)
+		{
+			textures[i].emplace_back(textureIDs.at(reference.m_RelativeFilepath), reference.m_Type, reference.m_RelativeFilepath);
+		}
+	}
+
+	// From node space to model space, parents are always resolved first.
+	std::vector<glm::mat4> nodeMatrices(m_Nodes.size());
+
+	for (size_t i = 0; i < m_Nodes.size(); i++)
+	{
+		nodeMatrices[i] = m_Nodes[i].m_Parent < 0 ? m_Nodes[i].m_LocalMatrix : nodeMatrices[m_Nodes[i].m_Parent] * m_Nodes[i].m_LocalMatrix;
+	}
+
+	for (const MeshData& mesh : meshes)
+	{
+		m_MeshNodes.push_back(mesh.m_Node);
+		m_MeshMatrices.push_back(mesh.m_Node < nodeMatrices.size() ? nodeMatrices[mesh.m_Node] : glm::mat4(1.0f));
+	}
+
+	if (m_Merged)
 	{
-		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+		// Merged meshes share one model matrix, their node transforms are applied to the vertices.
+		std::vector<std::vector<Vertex>> transformedVertices(meshes.size());
+		std::vector<MeshData> transformedMeshes = meshes;
+
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			if (m_MeshMatrices[i] != glm::mat4(1.0f))
+			{
+				glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(m_MeshMatrices[i])));
+
+				transformedVertices[i].assign(meshes[i].m_Vertices, meshes[i].m_Vertices + meshes[i].m_NumberOfVertices);
 
-		m_Meshes.push_back(processMesh(mesh, scene));
+				for (Vertex& vertex : transformedVertices[i])
+				{
+					vertex.m_Position = glm::vec3(m_MeshMatrices[i] * glm::vec4(vertex.m_Position, 1.0f));
+					vertex.m_Normal = glm::normalize(normalMatrix * vertex.m_Normal);
+					vertex.m_Tangent = glm::normalize(glm::mat3(m_MeshMatrices[i]) * vertex.m_Tangent);
+				}
+
+				transformedMeshes[i].m_Vertices = transformedVertices[i].data();
+			}
+
+			m_BoundingBox.extend(Mesh::computeBoundingBox(transformedMeshes[i].m_Vertices, transformedMeshes[i].m_NumberOfVertices));
+		}
+
+		m_MergedGeometry = std::make_unique<MergedGeometry>(transformedMeshes, textures);
+
+		return;
+	}
+
+	m_Meshes.reserve(meshes.size());
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		m_Meshes.emplace_back(meshes[i].m_Vertices, meshes[i].m_NumberOfVertices, meshes[i].m_Indices, meshes[i].m_NumberOfIndices, textures[i]);
+
+		// Culled in model space, see "cull".
+		BoundingBox box = m_Meshes[i].getBoundingBox().transform(m_MeshMatrices[i]);
+
+		m_BoundingBox.extend(box);
+		m_MeshBoundingBoxes.add(box);
+	}
+
+	m_MeshVisibility.resize(m_Meshes.size());
+	m_MeshWorldMatrices.resize(m_Meshes.size());
+}
+
+void Model::processNode(const aiNode* node, const aiScene* scene, const int parent, std::vector<const aiMesh*>& meshes, std::vector<unsigned int>& meshNodes)
+{
+	unsigned int index = (unsigned int)m_Nodes.size();
+
+	// Assimp's matrices are row-major, its rows are glm's columns.
+	const aiMatrix4x4& m = node->mTransformation;
+
+	m_Nodes.push_back({ node->mName.C_Str(), glm::mat4(m.a1, m.b1, m.c1, m.d1, m.a2, m.b2, m.c2, m.d2, m.a3, m.b3, m.c3, m.d3, m.a4, m.b4, m.c4, m.d4), parent });
+
+	// Gather all the node's meshes (if any).
+	for (unsigned int i = 0; i < node->mNumMeshes; i++)
+	{
+		meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+		meshNodes.push_back(index);
 	}
 
 	// Then do the same for each of its children.
 	for (unsigned int i = 0; i < node->mNumChildren; i++)
 	{
-		processNode(node->mChildren[i], scene);
+		processNode(node->mChildren[i], scene, (int)index, meshes, meshNodes);
 	}
 }
 
-Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
+Model::ImportedMesh Model::processMesh(const aiMesh* mesh, const aiScene* scene)
 {
-	std::vector<Vertex> vertices;
-	std::vector<unsigned int> indices;
-	std::vector<MeshTexture> textures;
+	ImportedMesh importedMesh;
+
+	std::vector<Vertex>& vertices = importedMesh.m_Vertices;
+	std::vector<unsigned int>& indices = importedMesh.m_Indices;
+	std::vector<MeshTextureReference>& textures = importedMesh.m_Textures;
+
+	// Faces are triangles (see "aiProcess_Triangulate").
+	vertices.resize(mesh->mNumVertices);
+	indices.reserve(mesh->mNumFaces * 3);
 
 	// Process vertex positions, normals and texture coordinates.
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
-		Vertex vertex;
+		Vertex& vertex = vertices[i];
 
 		vertex.m_Position.x = mesh->mVertices[i].x;
 		vertex.m_Position.y = mesh->mVertices[i].y;
@@ -99,130 +545,97 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
 			vertex.m_TexCoords = glm::vec2(0.0f, 0.0f);
 		}
 
-		vertex.m_Tangent.x = mesh->mTangents[i].x;
-		vertex.m_Tangent.y = mesh->mTangents[i].y;
-		vertex.m_Tangent.z = mesh->mTangents[i].z;
-
-		vertices.push_back(vertex);
+		vertex.m_Tangent = glm::vec3(0.0f, 0.0f, 0.0f);
 	}
 
 	// Process indices.
 	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
 	{
-		aiFace face = mesh->mFaces[i];
+		const aiFace& face = mesh->mFaces[i];
 
-		for (unsigned int j = 0; j < face.mNumIndices; j++)
-		{
-			indices.push_back(face.mIndices[j]);
-		}
+		indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
 	}
 
+	calculateTangents(importedMesh);
+
 	// Process material.
 	if (mesh->mMaterialIndex >= 0)
 	{
-		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+		const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
-		std::vector<MeshTexture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "TEXTURE_DIFFUSE");
+		std::vector<MeshTextureReference> diffuseMaps = getMaterialTextures(material, aiTextureType_DIFFUSE, "TEXTURE_DIFFUSE");
 		textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
 
-		std::vector<MeshTexture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "TEXTURE_SPECULAR");
+		std::vector<MeshTextureReference> specularMaps = getMaterialTextures(material, aiTextureType_SPECULAR, "TEXTURE_SPECULAR");
 		textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
 
-		std::vector<MeshTexture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "TEXTURE_NORMAL");
+		std::vector<MeshTextureReference> normalMaps = getMaterialTextures(material, aiTextureType_HEIGHT, "TEXTURE_NORMAL");
 		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
 	}
 
-	return Mesh(vertices, indices, textures);
+	return importedMesh;
 }
 
-unsigned int Model::loadTexture(const char* filepath)
+void Model::calculateTangents(ImportedMesh& mesh)
 {
-	stbi_set_flip_vertically_on_load(true);
-
-	unsigned int textureID;
-	int width, height, colorChannels, format = GL_RED; // Default format.
-	unsigned char* data = stbi_load(filepath, &width, &height, &colorChannels, 0);
-
-	// WARNING: We are only expecting an image with 3 or 4 color channels.
-	//			Any other format may generate some OpenGL error.
+	std::vector<Vertex>& vertices = mesh.m_Vertices;
+	const std::vector<unsigned int>& indices = mesh.m_Indices;
 
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
-
-	switch (colorChannels)
+	// Accumulate the tangent of every triangle into its vertices, so shared vertices get
+	// an area-weighted average.
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
 	{
-	case 3:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		format = GL_RGB;
+		Vertex& v0 = vertices[indices[i + 0]];
+		Vertex& v1 = vertices[indices[i + 1]];
+		Vertex& v2 = vertices[indices[i + 2]];
 
-		break;
+		glm::vec3 edge1 = v1.m_Position - v0.m_Position;
+		glm::vec3 edge2 = v2.m_Position - v0.m_Position;
+		glm::vec2 deltaUV1 = v1.m_TexCoords - v0.m_TexCoords;
+		glm::vec2 deltaUV2 = v2.m_TexCoords - v0.m_TexCoords;
 
-	case 4:
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		float determinant = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
 
-		format = GL_RGBA;
-
-		break;
+		// Degenerate texture coordinates, the triangle has no meaningful tangent.
+		if (std::abs(determinant) < 1e-12f)
+		{
+			continue;
+		}
 
-	default:
-		std::cout << "[ERROR] MODEL: Texture format not supported." << std::endl;
+		glm::vec3 tangent = (edge1 * deltaUV2.y - edge2 * deltaUV1.y) / determinant;
 
-		break;
+		v0.m_Tangent += tangent;
+		v1.m_Tangent += tangent;
+		v2.m_Tangent += tangent;
 	}
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
+	// Gram-Schmidt, each tangent is made orthogonal to its normal.
+	for (Vertex& vertex : vertices)
 	{
-		std::cout << "[ERROR] MODEL: Failed to load texture in \"" << filepath << "\"." << std::endl;
-	}
+		glm::vec3 tangent = vertex.m_Tangent - vertex.m_Normal * glm::dot(vertex.m_Normal, vertex.m_Tangent);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+		if (glm::dot(tangent, tangent) < 1e-12f)
+		{
+			// Any direction orthogonal to the normal does the job.
+			glm::vec3 axis = std::abs(vertex.m_Normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
 
-	stbi_image_free(data);
+			tangent = glm::cross(vertex.m_Normal, axis);
+		}
 
-	return textureID;
+		vertex.m_Tangent = glm::normalize(tangent);
+	}
 }
 
-std::vector<MeshTexture> Model::loadMaterialTextures(aiMaterial* material, aiTextureType type, std::string typeName)
+std::vector<MeshTextureReference> Model::getMaterialTextures(const aiMaterial* material, aiTextureType type, std::string typeName)
 {
-	std::vector<MeshTexture> textures;
+	std::vector<MeshTextureReference> textures;
 
 	for (unsigned int i = 0; i < material->GetTextureCount(type); i++)
 	{
 		aiString buffer;
 		material->GetTexture(type, i, &buffer);
 
-		bool skip = false;
-		std::string relativeFilepath = buffer.C_Str();
-
-		for (unsigned int j = 0; j < m_LoadedTextures.size(); j++)
-		{
-			if (relativeFilepath == m_LoadedTextures[j].m_RelativeFilepath)
-			{
-				textures.push_back(m_LoadedTextures[j]);
-				skip = true;
-
-				break;
-			}
-		}
-
-		if (!skip)
-		{
-			std::string completeFilepath = m_Directory + "/" + relativeFilepath;
-			unsigned int textureID = loadTexture(completeFilepath.c_str());
-
-			textures.push_back(MeshTexture (textureID, typeName, relativeFilepath));
-		}
+		textures.push_back({ typeName, buffer.C_Str() });
 	}
 
 	return textures;
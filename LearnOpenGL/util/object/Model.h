@@ -1,7 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <future>
 #include <string>
 #include <vector>
+#include <memory>
+#include <unordered_map>
 
 #include <glad/glad.h>
 
@@ -16,28 +20,83 @@
 #endif // _STB_IMAGE_INCLUDED
 
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "MergedGeometry.h"
+
+#include "../ThreadPool.h"
+#include "../TextureCache.h"
+#include "../TextureManager.h"
+#include "../Frustum.h"
+#include "../SceneGraph.h"
 
 #include "../../core/ShaderProgram.h"
+#include "../../core/RenderQueue.h"
 
 class Model
 {
 public:
-	Model(const char* filepath);
+	// Merged models keep all their meshes in a single "MergedGeometry" instead of one "Mesh" each.
+	Model(const char* filepath, TextureManager* textureManager = nullptr, const bool merged = false);
 	~Model();
 
-	void draw(ShaderProgram* shaderProgram);
+	// Textures are released on destruction, copies would release them twice.
+	Model(const Model&) = delete;
+	Model& operator=(const Model&) = delete;
+
+	// Meshes outside of the frustum (in world space), if any, are skipped. The transforms of the
+	// imported nodes are applied on top of the model matrix.
+	void draw(ShaderProgram* shaderProgram, const glm::mat4& modelMatrix = glm::mat4(1.0f), const Frustum* frustum = nullptr);
+	void submit(RenderQueue& renderQueue, ShaderProgram* shaderProgram, const glm::mat4& modelMatrix, const unsigned int pass = 0, const float depth = 0.0f, const Frustum* frustum = nullptr);
+
+	// Adds an instance node under "parent" and the imported node hierarchy under it, so that each
+	// node can be moved on its own. Returns the instance node, to submit the instance with.
+	unsigned int instantiate(SceneGraph& sceneGraph, const unsigned int parent = SceneGraph::s_NoParent) const;
+	void submit(RenderQueue& renderQueue, ShaderProgram* shaderProgram, const SceneGraph& sceneGraph, const unsigned int instance, const unsigned int pass = 0, const float depth = 0.0f, const Frustum* frustum = nullptr);
 
-	const std::vector<Mesh>& getMeshes();
+	const std::vector<Mesh>& getMeshes(); // Empty when merged.
+	const MergedGeometry* getMergedGeometry(); // Null unless merged.
+	const BoundingBox& getBoundingBox(); // In model space.
+	const std::vector<MeshNode>& getNodes();
 	const std::vector<MeshTexture>& getLoadedTextures();
 
 private:
+	// Part of the mesh cache entries, a change re-imports the models.
+	static const unsigned int s_ImportFlags = aiProcess_Triangulate | aiProcess_FlipUVs;
+
+	struct ImportedMesh
+	{
+		std::vector<Vertex> m_Vertices;
+		std::vector<unsigned int> m_Indices;
+		std::vector<MeshTextureReference> m_Textures;
+	};
+
 	std::vector<Mesh> m_Meshes;
-	std::vector<MeshTexture> m_LoadedTextures;
+	std::unique_ptr<MergedGeometry> m_MergedGeometry;
+	bool m_Merged;
+
+	std::vector<MeshNode> m_Nodes; // Imported hierarchy, parents first.
+	std::vector<unsigned int> m_MeshNodes; // Per mesh.
+	std::vector<glm::mat4> m_MeshMatrices; // Per mesh, from its node to the model space.
+	std::vector<glm::mat4> m_MeshWorldMatrices; // Per mesh, filled by each "submit".
+
+	BoundingBox m_BoundingBox; // Of all the meshes, merged ones are only culled as a whole.
+	BoundingBoxSet m_MeshBoundingBoxes;
+	std::vector<unsigned char> m_MeshVisibility; // Filled by each culled draw.
+	std::vector<MeshTexture> m_LoadedTextures; // One reference to the texture cache each.
 	std::string m_Directory;
+	TextureManager* m_TextureManager; // Textures are streamed in by it, if any.
 
+	ShaderProgram* m_MaterialProgram; // Last program the meshes were drawn with.
+	UniformHandle m_ModelMatrixHandle;
+
+	void submitItems(RenderQueue& renderQueue, ShaderProgram* shaderProgram, const glm::mat4& modelMatrix, const unsigned int pass, const float depth, const bool culled);
+	void prepareProgram(ShaderProgram* shaderProgram);
+	bool cull(const Frustum& frustum); // Is anything visible.
 	void loadModel(const std::string& filepath);
-	void processNode(aiNode* node, const aiScene* scene);
-	Mesh processMesh(aiMesh* mesh, const aiScene* scene);
-	unsigned int loadTexture(const char* filepath);
-	std::vector<MeshTexture> loadMaterialTextures(aiMaterial* material, aiTextureType type, std::string typeName);
+	void createMeshes(const std::vector<MeshData>& meshes, const std::unordered_map<std::string, unsigned int>& textureIDs);
+	void processNode(const aiNode* node, const aiScene* scene, const int parent, std::vector<const aiMesh*>& meshes, std::vector<unsigned int>& meshNodes);
+
+	static ImportedMesh processMesh(const aiMesh* mesh, const aiScene* scene);
+	static void calculateTangents(ImportedMesh& mesh);
+	static std::vector<MeshTextureReference> getMaterialTextures(const aiMaterial* material, aiTextureType type, std::string typeName);
 };
\ No newline at end of file